@@ -0,0 +1,167 @@
+/*!
+	@file main.cpp
+	@author   Gavin Lyons
+	@brief  This file contains the "main" function for a benchmark of the public API.
+		For each operation and screen size it reports I2C transactions, bytes on the wire,
+		modelled wire time at each BCM2835_I2C_CLOCK_DIVIDER speed and CPU time, as JSON.
+		No hardware needed.
+	@note
+	-# Bus numbers come from HD44780TransportSim, one run per clock divider
+	-# CPU time is measured against a transport that discards the bytes, so it is library time only
+	-# Usage : ./bin/test [file.json] , JSON written to stdout if no file given
+	-# Build with optimisation for meaningful CPU numbers, e.g. add -O2 to CFLAGS in makefile
+*/
+
+// Section: Included library
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include "HD44780_LCD.hpp"
+#include "HD44780_LCD_Sim.hpp"
+
+// Section: Defines
+#define BENCH_ITERATIONS 2000
+
+// Section: Types
+
+// Transport that accepts and discards everything, for CPU time
+class BenchNullTransport : public HD44780Transport {
+  public:
+	bool I2CBegin(void) override { return true; }
+	void I2CEnd(void) override { }
+	void I2CSpeedSet(uint16_t) override { }
+	void I2CAddressSet(uint8_t) override { }
+	uint8_t I2CWrite(const char *, uint32_t) override { return BCM2835_I2C_REASON_OK; }
+	uint8_t I2CRead(char *buffer, uint32_t length) override { memset(buffer, 0, length); return BCM2835_I2C_REASON_OK; }
+	void DelayMs(uint32_t) override { }
+	void DelayUs(uint32_t) override { }
+};
+
+struct BenchGeometry {
+	uint8_t Rows;
+	uint8_t Cols;
+};
+
+struct BenchOperation {
+	const char *Name;
+	std::function<void(HD44780PCF8574LCD &, const BenchGeometry &)> Setup; // not measured
+	std::function<void(HD44780PCF8574LCD &, const BenchGeometry &)> Run; // measured
+};
+
+// Section: Globals
+const BenchGeometry Geometries[] = { {2, 16}, {4, 20}, {2, 40} };
+const uint16_t Dividers[] = {
+	BCM2835_I2C_CLOCK_DIVIDER_2500, BCM2835_I2C_CLOCK_DIVIDER_626,
+	BCM2835_I2C_CLOCK_DIVIDER_150, BCM2835_I2C_CLOCK_DIVIDER_148 };
+uint8_t Smiley[8] = {0x00, 0x0A, 0x0A, 0x00, 0x11, 0x0E, 0x00, 0x00};
+uint32_t Toggle = 0; // alternates content/position so repeated runs are never no-ops
+
+// Section: Function Prototypes
+void drawFrame(HD44780PCF8574LCD &lcd, const BenchGeometry &geometry, char fill);
+void benchmark(std::ostream &json, const BenchGeometry &geometry, const BenchOperation &operation, bool last);
+
+// Section: Main Loop
+
+int main(int argc, char **argv)
+{
+	const BenchOperation Operations[] = {
+		{ "LCDSendString",
+			[](HD44780PCF8574LCD &lcd, const BenchGeometry &){ lcd.LCDGOTO(lcd.LCDLineNumberOne, 0); },
+			[](HD44780PCF8574LCD &lcd, const BenchGeometry &){ char text[] = "Hello World"; lcd.LCDSendString(text); } },
+		{ "print(double)",
+			[](HD44780PCF8574LCD &lcd, const BenchGeometry &){ lcd.LCDGOTO(lcd.LCDLineNumberOne, 0); },
+			[](HD44780PCF8574LCD &lcd, const BenchGeometry &){ lcd.print(3.14159, 3); } },
+		{ "LCDClearScreen",
+			[](HD44780PCF8574LCD &, const BenchGeometry &){ },
+			[](HD44780PCF8574LCD &lcd, const BenchGeometry &){ lcd.LCDClearScreen(); } },
+		{ "LCDGOTO",
+			[](HD44780PCF8574LCD &lcd, const BenchGeometry &){ lcd.LCDGOTO(lcd.LCDLineNumberOne, 0); },
+			[](HD44780PCF8574LCD &lcd, const BenchGeometry &){
+				(Toggle++ & 1) ? lcd.LCDGOTO(lcd.LCDLineNumberOne, 0) : lcd.LCDGOTO(lcd.LCDLineNumberTwo, 3); } },
+		{ "LCDCreateCustomChar",
+			[](HD44780PCF8574LCD &, const BenchGeometry &){ },
+			[](HD44780PCF8574LCD &lcd, const BenchGeometry &){ lcd.LCDCreateCustomChar(0, Smiley); } },
+		{ "full-frame repaint",
+			[](HD44780PCF8574LCD &lcd, const BenchGeometry &geometry){
+				lcd.LCDShadowSet(true); drawFrame(lcd, geometry, 'A'); lcd.flush(); },
+			[](HD44780PCF8574LCD &lcd, const BenchGeometry &geometry){
+				drawFrame(lcd, geometry, (Toggle++ & 1) ? 'A' : 'B'); lcd.flush(); } },
+	};
+	const size_t numOperations = sizeof(Operations) / sizeof(Operations[0]);
+
+	std::ofstream file;
+	if (argc > 1) file.open(argv[1]);
+	std::ostream &json = (argc > 1) ? file : std::cout;
+	if (!json)
+	{
+		std::cout << "Error 1207: cannot open " << argv[1] << std::endl;
+		return 1;
+	}
+
+	BenchNullTransport versionBus;
+	HD44780PCF8574LCD versionLCD(2, 16, 0x27, 0, versionBus);
+	json << "{\n  \"library_version\": " << versionLCD.LCDVerNumGet()
+		<< ",\n  \"iterations\": " << BENCH_ITERATIONS << ",\n  \"results\": [\n";
+	for (const BenchGeometry &geometry : Geometries)
+		for (size_t op = 0; op < numOperations; op++)
+			benchmark(json, geometry, Operations[op], &geometry == &Geometries[2] && op == numOperations - 1);
+	json << "  ]\n}" << std::endl;
+	return 0;
+} // End of main
+
+// Section :  Functions
+
+// Draw a whole screen of one character in shadow mode
+void drawFrame(HD44780PCF8574LCD &lcd, const BenchGeometry &geometry, char fill)
+{
+	std::string line(geometry.Cols, fill);
+	for (uint8_t row = 1; row <= geometry.Rows; row++)
+	{
+		lcd.LCDGOTO(static_cast<HD44780PCF8574LCD::LCDLineNumber_e>(row), 0);
+		lcd.print(line);
+	}
+}
+
+// Run one operation for one screen size, write one JSON result object
+void benchmark(std::ostream &json, const BenchGeometry &geometry, const BenchOperation &operation, bool last)
+{
+	json << "    {\"geometry\": \"" << +geometry.Cols << "x" << +geometry.Rows
+		<< "\", \"operation\": \"" << operation.Name << "\", \"bus\": [";
+
+	// Bus cost, one fresh simulated display per clock divider
+	for (const uint16_t &divider : Dividers)
+	{
+		HD44780TransportSim sim(geometry.Rows, geometry.Cols, 0x27);
+		HD44780PCF8574LCD lcd(geometry.Rows, geometry.Cols, 0x27, divider, sim);
+		lcd.LCD_I2C_ON();
+		lcd.LCDInit(lcd.LCDCursorTypeOff);
+		operation.Setup(lcd, geometry);
+		Toggle = 0; // same run for every divider
+		sim.SimStatsReset();
+		operation.Run(lcd, geometry);
+		HD44780SimStats stats = sim.SimStatsGet();
+		json << ((&divider == &Dividers[0]) ? "\n" : ",\n")
+			<< "      {\"divider\": " << divider << ", \"transactions\": " << stats.Transactions
+			<< ", \"bytes\": " << stats.BytesWritten << ", \"wire_us\": " << stats.BusTimeUs
+			<< ", \"delay_us\": " << stats.DelayTimeUs << ", \"busy_violations\": " << stats.BusyViolations << "}";
+	}
+
+	// CPU time, library only
+	BenchNullTransport bus;
+	HD44780PCF8574LCD lcd(geometry.Rows, geometry.Cols, 0x27, 0, bus);
+	lcd.LCD_I2C_ON();
+	lcd.LCDInit(lcd.LCDCursorTypeOff);
+	operation.Setup(lcd, geometry);
+	std::clock_t cpuStart = std::clock();
+	auto wallStart = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) operation.Run(lcd, geometry);
+	double wallNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - wallStart).count();
+	double cpuNs = (std::clock() - cpuStart) * (1e9 / CLOCKS_PER_SEC);
+
+	json << "\n    ], \"cpu_ns\": " << cpuNs / BENCH_ITERATIONS << ", \"wall_ns\": " << wallNs / BENCH_ITERATIONS
+		<< "}" << (last ? "\n" : ",\n");
+}
+
+// *** EOF ***
@@ -0,0 +1,98 @@
+/*!
+	@file main.cpp
+	@author   Gavin Lyons
+	@brief  This file contains the "main" function for a microbenchmark of the
+		PCF8574 frame encoding, cost per character before and after the
+		compile time frame tables. No hardware needed.
+	@note
+	-# Before : nibbles and masks computed at run time for every byte, as in version 1.3.3
+	-# After : four frames copied from HD44780FrameTables
+	-# Build with optimisation for meaningful numbers, e.g. add -O2 to CFLAGS in makefile
+*/
+
+// Section: Included library
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include "HD44780_LCD_Frames.hpp"
+
+// Section: Defines
+#define BENCH_ITERATIONS 200000
+#define BENCH_LENGTH 80 // one 20x04 screen
+
+// Section: Globals
+uint8_t BackLight = 0x0F; // LCDBackLightOnMask, run time value as in the LCD class
+char FrameBuffer[BENCH_LENGTH * 4];
+
+// Section: Function Prototypes
+void encodeRuntime(const uint8_t *text, size_t length);
+void encodeTable(const uint8_t *text, size_t length);
+double benchmark(const char *name, void (*encode)(const uint8_t *, size_t), const uint8_t *text);
+
+// Section: Main Loop
+
+int main(int argc, char **argv)
+{
+	uint8_t text[BENCH_LENGTH];
+	for (uint8_t i = 0; i < BENCH_LENGTH; i++) text[i] = 0x20 + (i % 95);
+
+	// Check both encoders give the same frames
+	char check[BENCH_LENGTH * 4];
+	encodeRuntime(text, BENCH_LENGTH);
+	memcpy(check, FrameBuffer, sizeof(check));
+	encodeTable(text, BENCH_LENGTH);
+	if (memcmp(check, FrameBuffer, sizeof(check)) != 0)
+	{
+		std::cout << "Error 1204: frame tables do not match run time encoding" << std::endl;
+		return 1;
+	}
+
+	double before = benchmark("Before, run time encode", encodeRuntime, text);
+	double after = benchmark("After, table copy", encodeTable, text);
+	std::cout << "Speed up : " << before / after << "x" << std::endl;
+	return 0;
+} // End of main
+
+// Section :  Functions
+
+// Version 1.3.3 LCDSendData encoding, per byte nibble select + mask OR with backlight
+void encodeRuntime(const uint8_t *text, size_t length)
+{
+	const uint8_t LCDDataByteOn= 0x0D;
+	const uint8_t LCDDataByteOff = 0x09;
+	for (size_t i = 0; i < length; i++)
+	{
+		uint8_t dataNibbleLower = (text[i] << 4)&0xf0;
+		uint8_t dataNibbleUpper = text[i] & 0xf0;
+		FrameBuffer[i * 4 + 0] = dataNibbleUpper | (LCDDataByteOn & BackLight);
+		FrameBuffer[i * 4 + 1] = dataNibbleUpper | (LCDDataByteOff & BackLight);
+		FrameBuffer[i * 4 + 2] = dataNibbleLower | (LCDDataByteOn & BackLight);
+		FrameBuffer[i * 4 + 3] = dataNibbleLower | (LCDDataByteOff & BackLight);
+	}
+}
+
+// Table encoding, as LCDBatchDataRun
+void encodeTable(const uint8_t *text, size_t length)
+{
+	const HD44780FrameTable &table = HD44780FrameTables[1][BackLight == 0x0F];
+	for (size_t i = 0; i < length; i++)
+		memcpy(&FrameBuffer[i * 4], table.Frames[text[i]], 4);
+}
+
+// Time an encoder, print and return nS per character
+double benchmark(const char *name, void (*encode)(const uint8_t *, size_t), const uint8_t *text)
+{
+	volatile uint8_t sink = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < BENCH_ITERATIONS; i++)
+	{
+		encode(text, BENCH_LENGTH);
+		sink = sink + FrameBuffer[i % sizeof(FrameBuffer)];
+	}
+	double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	double perChar = ns / (static_cast<double>(BENCH_ITERATIONS) * BENCH_LENGTH);
+	std::cout << name << " : " << perChar << " nS per character" << std::endl;
+	return perChar;
+}
+
+// *** EOF ***
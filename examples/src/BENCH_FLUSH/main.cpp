@@ -0,0 +1,189 @@
+/*!
+	@file main.cpp
+	@author   Gavin Lyons
+	@brief  This file contains the "main" function for a benchmark of the flush() planners.
+		Update traces modelled on the demo programs are replayed in shadow mode onto a
+		simulated display, once with LCDFlushPerRun and once with LCDFlushCostModel,
+		and the bus bytes and set address commands of each are compared. No hardware needed.
+	@note
+	-# A trace is a hand written re-creation of a demo's draw calls, not a capture from a run,
+		with a flush() wherever the demo shows a frame
+	-# Set address commands are counted by the driver counters, LCDStatsGet().Commands
+	-# Returns non zero if the cost model ever sends more bytes than per run addressing
+*/
+
+// Section: Included library
+#include <iostream>
+#include <iomanip>
+#include <ctime>
+#include <functional>
+#include "HD44780_LCD.hpp"
+#include "HD44780_LCD_Sim.hpp"
+
+// Section: Types
+struct FlushTrace {
+	const char *Name;
+	uint8_t Rows;
+	uint8_t Cols;
+	std::function<void(HD44780PCF8574LCD &)> Record; // draw calls, flush() per frame
+};
+
+struct FlushResult {
+	uint32_t Bytes;
+	uint32_t AddressCommands;
+	std::string Screen;
+};
+
+// Section: Function Prototypes
+void traceClock(HD44780PCF8574LCD &lcd);
+void traceGoto(HD44780PCF8574LCD &lcd);
+void traceNumbers(HD44780PCF8574LCD &lcd);
+void traceRepaint(HD44780PCF8574LCD &lcd, uint8_t rows, uint8_t cols);
+FlushResult replay(const FlushTrace &trace, HD44780PCF8574LCD::LCDFlushPlan_e plan);
+
+// Section: Main Loop
+
+int main(int argc, char **argv)
+{
+	const FlushTrace Traces[] = {
+		{ "CLOCK_16x02 5 minutes", 2, 16, traceClock },
+		{ "TEST_20x04 gotoTest", 4, 20, traceGoto },
+		{ "TEST_20x04 writeNumTest", 4, 20, traceNumbers },
+		{ "BENCH_API repaint 20x04", 4, 20, [](HD44780PCF8574LCD &lcd){ traceRepaint(lcd, 4, 20); } },
+		{ "BENCH_API repaint 40x02", 2, 40, [](HD44780PCF8574LCD &lcd){ traceRepaint(lcd, 2, 40); } },
+	};
+	bool pass = true;
+
+	std::cout << std::left << std::setw(26) << "Trace" << std::right
+		<< std::setw(10) << "PerRun B" << std::setw(8) << "Addr"
+		<< std::setw(10) << "Model B" << std::setw(8) << "Addr"
+		<< std::setw(9) << "Saved B" << std::setw(8) << "Saved" << std::endl;
+	for (const FlushTrace &trace : Traces)
+	{
+		FlushResult perRun = replay(trace, HD44780PCF8574LCD::LCDFlushPerRun);
+		FlushResult model = replay(trace, HD44780PCF8574LCD::LCDFlushCostModel);
+		int32_t saved = static_cast<int32_t>(perRun.Bytes) - static_cast<int32_t>(model.Bytes);
+		std::cout << std::left << std::setw(26) << trace.Name << std::right
+			<< std::setw(10) << perRun.Bytes << std::setw(8) << perRun.AddressCommands
+			<< std::setw(10) << model.Bytes << std::setw(8) << model.AddressCommands
+			<< std::setw(9) << saved << std::setw(7) << std::fixed << std::setprecision(1)
+			<< (100.0 * saved / perRun.Bytes) << "%" << std::endl;
+		if (saved < 0 || perRun.Screen != model.Screen)
+		{
+			std::cout << "Error 1210: " << trace.Name << " cost model worse or screen differs" << std::endl;
+			pass = false;
+		}
+	}
+	return pass ? 0 : 1;
+} // End of main
+
+// Section :  Functions
+
+// Replay one trace with one flush planner, count the bus bytes and set address commands
+FlushResult replay(const FlushTrace &trace, HD44780PCF8574LCD::LCDFlushPlan_e plan)
+{
+	HD44780TransportSim sim(trace.Rows, trace.Cols, 0x27);
+	HD44780PCF8574LCD lcd(trace.Rows, trace.Cols, 0x27, 0, sim);
+	lcd.LCD_I2C_ON();
+	lcd.LCDInit(lcd.LCDCursorTypeOff);
+	lcd.LCDClearScreen();
+	lcd.LCDFlushPlanSet(plan);
+	lcd.LCDShadowSet(true);
+	sim.SimStatsReset();
+	lcd.LCDStatsReset();
+	trace.Record(lcd);
+	return { sim.SimStatsGet().BytesWritten, lcd.LCDStatsGet().Commands, sim.SimScreenGet() };
+}
+
+// CLOCK_16x02 DisplayInfo() once a second, over a change of year
+void traceClock(HD44780PCF8574LCD &lcd)
+{
+	std::time_t start = 1735689450; // 2024-12-31 23:57:30 UTC
+	for (std::time_t time = start; time < start + 300; time++)
+	{
+		char timeString[std::size("yyyy-mm-dd hh:mm:ss UTC")];
+		std::strftime(std::data(timeString), std::size(timeString), "%F %T UTC", std::gmtime(&time));
+		std::string TimeString = timeString;
+		lcd.LCDGOTO(lcd.LCDLineNumberOne, 0);
+		lcd.print(TimeString.substr(0, 10));
+		lcd.LCDGOTO(lcd.LCDLineNumberTwo, 0);
+		lcd.print(TimeString.substr(11));
+		lcd.flush();
+	}
+}
+
+// TEST_20x04 gotoTest(), a string per line then the ASCII table one cell at a time
+void traceGoto(HD44780PCF8574LCD &lcd)
+{
+	char teststr1[] = "Line 1";
+	char teststr2[] = "Line 2";
+	char teststr3[] = "Line 3";
+	char teststr4[] = "Line 4";
+	char testchar = '!';
+
+	lcd.LCDGOTO(lcd.LCDLineNumberOne, 0);
+	lcd.LCDSendString(teststr1);
+	lcd.LCDGOTO(lcd.LCDLineNumberTwo, 0);
+	lcd.LCDSendString(teststr2);
+	lcd.LCDGOTO(lcd.LCDLineNumberThree, 0);
+	lcd.LCDSendString(teststr3);
+	lcd.LCDGOTO(lcd.LCDLineNumberFour, 0);
+	lcd.LCDSendString(teststr4);
+	lcd.flush();
+	lcd.LCDClearScreen();
+	lcd.flush();
+	for (uint8_t row = 1; row <= 4; row++)
+	{
+		for (uint8_t columnPos = 0; columnPos < 20; columnPos++)
+		{
+			lcd.LCDGOTO(static_cast<HD44780PCF8574LCD::LCDLineNumber_e>(row), columnPos);
+			lcd.LCDSendChar(testchar++);
+		}
+		lcd.flush(); // demo pauses after each line
+	}
+	for (uint8_t row = 1; row <= 4; row++)
+	{
+		lcd.LCDClearLine(static_cast<HD44780PCF8574LCD::LCDLineNumber_e>(row));
+		lcd.flush();
+	}
+}
+
+// TEST_20x04 writeNumTest()
+void traceNumbers(HD44780PCF8574LCD &lcd)
+{
+	lcd.LCDGOTO(lcd.LCDLineNumberOne, 0);
+	lcd.print(193);
+	lcd.LCDGOTO(lcd.LCDLineNumberTwo, 0);
+	lcd.print(-8582);
+	lcd.LCDMoveCursor(lcd.LCDMoveRight, 2);
+	lcd.print(3.1456, 3);
+	lcd.flush();
+	lcd.LCDClearScreen();
+	lcd.flush();
+	lcd.LCDGOTO(lcd.LCDLineNumberOne, 0);
+	lcd.print(11);
+	lcd.LCDMoveCursor(lcd.LCDMoveRight, 2);
+	lcd.print(11, OCT);
+	lcd.LCDGOTO(lcd.LCDLineNumberTwo, 0);
+	lcd.print(11, HEX);
+	lcd.LCDMoveCursor(lcd.LCDMoveRight, 2);
+	lcd.print(11, BIN);
+	lcd.flush();
+}
+
+// BENCH_API full-frame repaint, every cell changes each frame
+void traceRepaint(HD44780PCF8574LCD &lcd, uint8_t rows, uint8_t cols)
+{
+	for (uint8_t frame = 0; frame < 50; frame++)
+	{
+		std::string line(cols, (frame & 1) ? 'B' : 'A');
+		for (uint8_t row = 1; row <= rows; row++)
+		{
+			lcd.LCDGOTO(static_cast<HD44780PCF8574LCD::LCDLineNumber_e>(row), 0);
+			lcd.print(line);
+		}
+		lcd.flush();
+	}
+}
+
+// *** EOF ***
@@ -8,6 +8,7 @@
 	-# set DebugSet(false) to true in Setup() for debug
 	-# For description of entry modes , cursor types, custom characters and more see here http://dinceraydin.com/lcd/commands.htm
 	-# -std=c++2a required in makefile
+	-# Uses shadow mode, flush() only sends the digits that changed each second
 	-# press ctrl + c to quit
  */
 
@@ -76,6 +77,7 @@ bool setup(void) {
 	myLCD.LCDInit(myLCD.LCDCursorTypeOn);
 	myLCD.LCDClearScreen();
 	myLCD.LCDBackLightSet(true);
+	myLCD.LCDShadowSet(true); // draw into shadow buffer, sent by flush()
 	
 	// print out library versions & flag status( Note optional)
 	std::cout << "bcm2835 library Version Number :" << bcm2835_version() << std::endl;
@@ -96,6 +98,7 @@ void DisplayInfo(void)
 	myLCD.print(timeInfo);
 	myLCD.LCDGOTO(myLCD.LCDLineNumberTwo, 0);
 	myLCD.print(DateInfo);
+	myLCD.flush();
 }
 
 
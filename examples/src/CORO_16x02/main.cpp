@@ -0,0 +1,158 @@
+/*!
+	@file main.cpp
+	@author   Gavin Lyons
+	@brief  This file contains the "main" function for the coroutine animation example.
+		Blink, countdown, spinner and scroll sequences run together from one thread,
+		each written as straight line code with co_await in place of bcm2835_delay.
+	@note
+	-# Usage : ./bin/test [-sim]
+	-# Hardware : one 16x02 at 0x27 runs every animation, 4 tasks on one display
+	-# -sim : two simulated 16x02 displays in virtual time, checks the result
+	-# Test 1216 :: coroutine animations
+*/
+
+// Section: Included library
+#include <iostream>
+#include <cstring>
+#include <string>
+#include <bcm2835.h>
+#include "HD44780_LCD.hpp"
+#include "HD44780_LCD_Sim.hpp"
+#include "HD44780_LCD_Coro.hpp"
+
+// Section: Globals
+HD44780LCDScheduler *Scheduler = nullptr;
+
+// Section: Function Prototypes
+HD44780LCDTask blink(HD44780PCF8574LCD &lcd, uint8_t row, uint8_t col, std::string text, uint8_t times, uint16_t periodMs);
+HD44780LCDTask countdown(HD44780PCF8574LCD &lcd, uint8_t row, uint8_t col, uint8_t from);
+HD44780LCDTask spinner(HD44780PCF8574LCD &lcd, uint8_t row, uint8_t col, uint16_t steps, uint16_t periodMs);
+HD44780LCDTask banner(HD44780PCF8574LCD &lcd, uint8_t row, uint8_t width, std::string text, uint16_t stepMs);
+uint8_t gotoPrint(HD44780PCF8574LCD &lcd, uint8_t row, uint8_t col, const std::string &text);
+
+// Section: Main Loop
+
+int main(int argc, char **argv)
+{
+	bool simulate = (argc > 1 && strcmp(argv[1], "-sim") == 0);
+	if (!simulate && !bcm2835_init())
+	{
+		std::cout << "Error 1201: init bcm2835 library , Is it installed ?" << std::endl;
+		return 1;
+	}
+
+	HD44780TransportSim simA(2, 16, 0x27), simB(2, 16, 0x27);
+	HD44780TransportBCM2835 bus;
+	HD44780PCF8574LCD lcdA(2, 16, 0x27, BCM2835_I2C_CLOCK_DIVIDER_626,
+		simulate ? static_cast<HD44780Transport &>(simA) : bus);
+	HD44780PCF8574LCD lcdB(2, 16, 0x27, BCM2835_I2C_CLOCK_DIVIDER_626, simB);
+	HD44780PCF8574LCD &second = simulate ? lcdB : lcdA; // one panel on hardware
+	for (HD44780PCF8574LCD *lcd : {&lcdA, &lcdB})
+	{
+		if (!simulate && lcd == &lcdB) break;
+		if (!lcd->LCD_I2C_ON())
+		{
+			std::cout << "Error 1202: bcm2835_i2c_begin :Cannot start I2C, Running as root?" << std::endl;
+			if (!simulate) bcm2835_close();
+			return 1;
+		}
+		lcd->LCDInit(lcd->LCDCursorTypeOff);
+		lcd->LCDWaitModeSet(lcd->LCDWaitDeferred); // slow commands waited out by other tasks
+		lcd->LCDClearScreenCmd();
+	}
+
+	HD44780LCDScheduler scheduler(simulate); // virtual time on the simulator
+	Scheduler = &scheduler;
+	scheduler.SchedulerSpawn(blink(lcdA, 0, 0, "Ready", 4, 500));
+	scheduler.SchedulerSpawn(countdown(lcdA, 0, 12, 5));
+	scheduler.SchedulerSpawn(spinner(second, 1, 15, 40, 125));
+	scheduler.SchedulerSpawn(banner(second, simulate ? 0 : 1, 15, "Coroutines", 200));
+	scheduler.SchedulerRun();
+
+	bool pass = true;
+	if (simulate)
+	{
+		std::cout << simA.SimScreenGet() << std::endl << simB.SimScreenGet() << std::endl;
+		uint32_t violations = simA.SimStatsGet().BusyViolations + simB.SimStatsGet().BusyViolations;
+		std::cout << "Virtual time uS " << scheduler.SchedulerNowUs() << " , busy violations " << violations << std::endl;
+		// 5 S of sleeps, plus the spinner sleeps out the clear and the home on its display, 2 x 1.52 mS
+		if (simA.SimLineGet(1) != "Ready       Go! " || simA.SimLineGet(2) != "                "
+			|| simB.SimLineGet(1) != "Coroutines      " || simB.SimLineGet(2) != "               o"
+			|| scheduler.SchedulerNowUs() < 5000000 || scheduler.SchedulerNowUs() > 5003040 || violations != 0)
+		{
+			std::cout << "Error 1216: coroutine animations" << std::endl;
+			pass = false;
+		}
+		std::cout << "Coroutine test " << (pass ? "PASS" : "FAIL") << std::endl;
+	}
+	else
+	{
+		lcdA.LCDDisplayON(false);
+		lcdA.LCD_I2C_OFF();
+		bcm2835_close();
+	}
+	return pass ? 0 : 1;
+} // End of main
+
+// Section :  Functions
+
+// Text on for half a period and off for the other half
+HD44780LCDTask blink(HD44780PCF8574LCD &lcd, uint8_t row, uint8_t col, std::string text, uint8_t times, uint16_t periodMs)
+{
+	for (uint8_t count = 0; count < times; count++)
+	{
+		co_await Scheduler->SchedulerOp(lcd, [&]{ return gotoPrint(lcd, row, col, text); });
+		co_await Scheduler->SchedulerSleepMs(periodMs / 2);
+		co_await Scheduler->SchedulerOp(lcd, [&]{ return gotoPrint(lcd, row, col, std::string(text.size(), ' ')); });
+		co_await Scheduler->SchedulerSleepMs(periodMs / 2);
+	}
+	co_await Scheduler->SchedulerOp(lcd, [&]{ return gotoPrint(lcd, row, col, text); });
+}
+
+// One second steps down to zero, then "Go!"
+HD44780LCDTask countdown(HD44780PCF8574LCD &lcd, uint8_t row, uint8_t col, uint8_t from)
+{
+	for (uint8_t value = from; value > 0; value--)
+	{
+		co_await Scheduler->SchedulerOp(lcd, [&]{ return gotoPrint(lcd, row, col, std::to_string(value) + "   "); });
+		co_await Scheduler->SchedulerSleepMs(1000);
+	}
+	co_await Scheduler->SchedulerOp(lcd, [&]{ return gotoPrint(lcd, row, col, "Go! "); });
+}
+
+// Cycles a character in one cell
+HD44780LCDTask spinner(HD44780PCF8574LCD &lcd, uint8_t row, uint8_t col, uint16_t steps, uint16_t periodMs)
+{
+	const char frames[] = {'.', 'o', 'O', 'o'};
+	for (uint16_t step = 0; step < steps; step++)
+	{
+		co_await Scheduler->SchedulerOp(lcd, [&]{ return gotoPrint(lcd, row, col, std::string(1, frames[step % 4])); });
+		co_await Scheduler->SchedulerSleepMs(periodMs);
+	}
+}
+
+// Slides text in from the right of a width wide field, then rests it on the left
+HD44780LCDTask banner(HD44780PCF8574LCD &lcd, uint8_t row, uint8_t width, std::string text, uint16_t stepMs)
+{
+	for (uint8_t col = width; col > 0; col--)
+	{
+		std::string frame = text.substr(0, width - col + 1) + " ";
+		frame.resize(width - col + 1, ' '); // clipped at the field edge
+		co_await Scheduler->SchedulerOp(lcd, [&]{ return gotoPrint(lcd, row, col - 1, frame); });
+		co_await Scheduler->SchedulerSleepMs(stepMs);
+	}
+	// Return home takes 1.52mS, the next operation on this display sleeps it out
+	co_await Scheduler->SchedulerOp(lcd, [&]{ return lcd.LCDHome(); });
+	co_await Scheduler->SchedulerSleepMs(1000);
+	co_await Scheduler->SchedulerOp(lcd, [&]{ return gotoPrint(lcd, row, 0, text); });
+}
+
+// Move the cursor and print, one display operation
+uint8_t gotoPrint(HD44780PCF8574LCD &lcd, uint8_t row, uint8_t col, const std::string &text)
+{
+	uint8_t status = lcd.LCDGOTO(static_cast<HD44780PCF8574LCD::LCDLineNumber_e>(row + 1), col);
+	lcd.print(text.c_str());
+	return status | lcd.LCDI2CErrorGet();
+}
+
+// *** EOF ***
@@ -0,0 +1,140 @@
+/*!
+	@file main.cpp
+	@author   Gavin Lyons
+	@brief  This file contains the "main" function for the display daemon example.
+		The daemon owns the I2C bus and a 16x02 display, other processes write
+		characters into its shared memory framebuffer and send commands to its socket.
+	@note
+	-# Usage : ./bin/test [name] [-rate hz] [-sim] [-selftest]
+	-# name defaults to "lcd", framebuffer /dev/shm/hd44780_lcd , socket /tmp/hd44780_lcd.sock
+	-# -sim serves the simulated display instead of hardware, screen printed on exit
+	-# -selftest runs a client thread against the simulated display and checks the result
+	-# Try from a shell : echo "backlight off" | nc -U /tmp/hd44780_lcd.sock
+		printf 'Hello' | dd of=/dev/shm/hd44780_lcd bs=1 seek=12 conv=notrunc
+	-# Test 1215 :: daemon self test
+*/
+
+// Section: Included library
+#include <iostream>
+#include <thread>
+#include <csignal>
+#include <cstring>
+#include <bcm2835.h>
+#include "HD44780_LCD.hpp"
+#include "HD44780_LCD_Sim.hpp"
+#include "HD44780_LCD_Daemon.hpp"
+
+// Section: Globals
+HD44780LCDDaemon *Daemon = nullptr; // for the signal handler
+
+// Section: Function Prototypes
+void stopDaemon(int);
+bool selfTestClient(const std::string &name);
+
+// Section: Main Loop
+
+int main(int argc, char **argv)
+{
+	std::string name = "lcd";
+	uint16_t rate = 20;
+	bool simulate = false, selfTest = false;
+	for (int arg = 1; arg < argc; arg++)
+	{
+		if (strcmp(argv[arg], "-sim") == 0) simulate = true;
+		else if (strcmp(argv[arg], "-selftest") == 0) simulate = selfTest = true;
+		else if (strcmp(argv[arg], "-rate") == 0 && arg + 1 < argc) rate = atoi(argv[++arg]);
+		else name = argv[arg];
+	}
+	if (!simulate && !bcm2835_init())
+	{
+		std::cout << "Error 1201: init bcm2835 library , Is it installed ?" << std::endl;
+		return 1;
+	}
+
+	HD44780TransportSim sim(2, 16, 0x27);
+	HD44780TransportBCM2835 bus;
+	HD44780Transport &transport = simulate ? static_cast<HD44780Transport &>(sim) : bus;
+	HD44780PCF8574LCD myLCD(2, 16, 0x27, BCM2835_I2C_CLOCK_DIVIDER_626, transport);
+	if (!myLCD.LCD_I2C_ON())
+	{
+		std::cout << "Error 1202: bcm2835_i2c_begin :Cannot start I2C, Running as root?" << std::endl;
+		if (!simulate) bcm2835_close();
+		return 1;
+	}
+	myLCD.LCDInit(myLCD.LCDCursorTypeOff);
+	myLCD.LCDClearScreen();
+	myLCD.LCDHealthSet(1000); // re-init and redraw after a brown out, checked from the flushes
+
+	HD44780LCDDaemon daemon(rate);
+	if (!daemon.DaemonAdd(myLCD, name))
+	{
+		std::cout << "Error 1215: cannot create " << HD44780LCDDaemon::DaemonShmName(name)
+			<< " or " << HD44780LCDDaemon::DaemonSocketPath(name) << std::endl;
+		return 1;
+	}
+	Daemon = &daemon;
+	signal(SIGINT, stopDaemon);
+	signal(SIGTERM, stopDaemon);
+	std::cout << "Serving " << HD44780LCDDaemon::DaemonSocketPath(name) << " at " << rate << " Hz" << std::endl;
+
+	bool pass = true;
+	std::thread client;
+	if (selfTest) client = std::thread([&pass, &daemon, name](){
+		if (!(pass = selfTestClient(name))) daemon.DaemonStop(); // else stopped by quit
+	});
+	daemon.DaemonRun();
+	if (client.joinable()) client.join();
+
+	if (selfTest)
+	{
+		if (sim.SimLineGet(1) != "Daemon  \x01 test  " || sim.SimLineGet(2) != "Rate 50  cursor "
+			|| sim.SimCGRAMGet(8) != 0x1F || sim.SimAddressCounterGet() != 0x49
+			|| (sim.SimDisplayControlGet() & 0x03) != 0x02 || sim.SimBackLightGet() == true)
+		{
+			std::cout << "Error 1215: daemon screen or state" << std::endl;
+			pass = false;
+		}
+	}
+	if (simulate) std::cout << sim.SimScreenGet() << std::endl;
+	myLCD.LCDShadowSet(false);
+	myLCD.LCD_I2C_OFF();
+	if (!simulate) bcm2835_close();
+	if (selfTest) std::cout << "Daemon self test " << (pass ? "PASS" : "FAIL") << std::endl;
+	return pass ? 0 : 1;
+} // End of main
+
+// Section :  Functions
+
+void stopDaemon(int)
+{
+	if (Daemon != nullptr) Daemon->DaemonStop();
+}
+
+// What another process would do, here a thread so the example is self contained
+bool selfTestClient(const std::string &name)
+{
+	HD44780DaemonClient client;
+	if (!client.ClientOpen(name)) return false;
+	HD44780DaemonShm *shm = client.ClientShmGet();
+
+	bool ok = client.ClientCommand("glyph 1 1f 11 11 11 11 11 11 1f") == "OK"; // hollow box
+	client.ClientPrint(0, 0, "Daemon  ");
+	shm->Cells[8] = 0x01; // custom glyph, a plain memory write
+	client.ClientPrint(0, 9, " test");
+	client.ClientPrint(1, 0, "Rate 50  cursor");
+	ok &= client.ClientCommand("rate 50") == "OK";
+	ok &= client.ClientCommand("cursor 1 9") == "OK";
+	ok &= client.ClientCommand("cursortype on") == "OK";
+	ok &= client.ClientCommand("backlight off") == "OK";
+	ok &= client.ClientCommand("cursor 2 0") == "ERR out of range";
+	ok &= client.ClientCommand("beep") == "ERR unknown command";
+
+	uint32_t flushes = shm->Flushes; // wait for two periodic flushes, no command needed
+	while (shm->Flushes < flushes + 2) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	ok &= shm->RateHz == 50;
+	ok &= client.ClientCommand("quit") == "OK";
+	if (!ok) std::cout << "Error 1215: daemon command reply" << std::endl;
+	return ok;
+}
+
+// *** EOF ***
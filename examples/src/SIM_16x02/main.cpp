@@ -0,0 +1,568 @@
+/*!
+	@file main.cpp
+	@author   Gavin Lyons
+	@brief  This file contains the "main" function for a simulated display demo (16x02 LCD)
+		The library is run against HD44780TransportSim, a software PCF8574 + HD44780,
+		so no hardware or root access is needed.
+	@note
+	-# Prints the bus cost and wall time of each API call
+	-# Checks the emulated screen contents, returns non zero on mismatch
+	-# Async mode, calls return at once and a worker thread drains the bus work
+	-# Async ring filled while the bus is stalled, depth capped at 32768 slots
+	-# Wait modes, fixed mS delays versus datasheet uS versus busy flag polling
+	-# Glyph registry, ten icons shared over the 8 CGRAM slots
+	-# Driver counters and latency histogram, with a disconnected display
+	-# Retry backoff and circuit breaker, status codes returned by the API, also in async mode
+	-# Compile time sized HD44780LCD<1, 16>, 16x1 split addressing
+	-# UTF-8 text mapped to the A00 character ROM, glyph and replacement fallback
+	-# Marquee, a long message scrolled by display shift with off screen refills
+	-# Cursor moves and scrolls sent as the shortest command sequence, shadow moves stop at column 0
+	-# Page flip through the off screen DDRAM columns
+	-# Warm start, a restarted program adopts the running display from a snapshot,
+		then from a display put out of step by a stray nibble
+	-# Health check, display power cycled or out of step, re-initialised and replayed
+	-# Health check, a stray nibble with and without a failed transfer, recovery read back
+	-# Write NACKed part way and retried, the address counter set back first
+	-# 20x4 flush over two transfers, the first lost, the lost cells sent again
+*/
+
+// Section: Included library
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include "HD44780_LCD.hpp"
+#include "HD44780_LCD_Sim.hpp"
+
+// Section: Class's
+
+// Simulator that NACKs one chosen write, for a failure part way through a long transfer,
+// or puts a stray nibble ahead of one, for a 4-bit interface out of step,
+// or holds writes, for a stalled bus filling the async ring
+class HD44780TransportSimFlaky : public HD44780TransportSim {
+  public:
+	using HD44780TransportSim::HD44780TransportSim;
+	uint32_t FailWrite = 0; /**< Writes until the one to NACK, 0 = none */
+	uint32_t FailLatched = 0; /**< Frame bytes of the NACKed write that reach the display first */
+	uint32_t StrayWrite = 0; /**< Writes until the one a stray nibble goes ahead of, 0 = none */
+	std::atomic<bool> Hold{false}; /**< Writes wait while set */
+	uint8_t I2CWrite(const char *buffer, uint32_t length) override
+	{
+		while (Hold.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		const char stray[2] = {0x0C, 0x08}; // command nibble 0x0, EN high then low
+		if (StrayWrite > 0 && --StrayWrite == 0) HD44780TransportSim::I2CWrite(stray, sizeof(stray));
+		if (FailWrite > 0 && --FailWrite == 0)
+		{
+			if (FailLatched > 0) HD44780TransportSim::I2CWrite(buffer, FailLatched);
+			return BCM2835_I2C_REASON_ERROR_NACK;
+		}
+		return HD44780TransportSim::I2CWrite(buffer, length);
+	}
+};
+
+// Section: Globals
+// mySim(rows , cols , PCF8574 I2C address)
+HD44780TransportSim mySim(2, 16, 0x27);
+// myLCD(rows , cols , PCF8574 I2C address, I2C speed, transport)
+HD44780PCF8574LCD myLCD(2, 16, 0x27, BCM2835_I2C_CLOCK_DIVIDER_626, mySim);
+
+// Section: Function Prototypes
+void measure(const char *name, std::function<void(void)> apiCall);
+bool checkLine(uint8_t lineNo, const std::string &expected);
+
+// Section: Main Loop
+
+int main(int argc, char **argv)
+{
+	bool pass = true;
+	char teststr1[] = "Hello";
+
+	std::cout << "LCD Simulation Begin" << std::endl;
+	myLCD.LCD_I2C_ON();
+	measure("LCDInit", [](){ myLCD.LCDInit(myLCD.LCDCursorTypeOn); });
+	measure("LCDClearScreen", [](){ myLCD.LCDClearScreen(); });
+	measure("LCDGOTO", [](){ myLCD.LCDGOTO(myLCD.LCDLineNumberOne, 0); });
+	measure("LCDSendString", [&](){ myLCD.LCDSendString(teststr1); });
+	measure("LCDGOTO", [](){ myLCD.LCDGOTO(myLCD.LCDLineNumberTwo, 0); });
+	measure("print(double)", [](){ myLCD.print(3.1456, 3); });
+	measure("LCDGOTO already there", [](){ myLCD.LCDGOTO(myLCD.LCDLineNumberTwo, 5); });
+	pass &= checkLine(1, "Hello           ");
+	pass &= checkLine(2, "3.146           ");
+
+	myLCD.LCDShadowSet(true);
+	myLCD.LCDGOTO(myLCD.LCDLineNumberOne, 0);
+	myLCD.print("Hello World");
+	myLCD.LCDGOTO(myLCD.LCDLineNumberTwo, 0);
+	myLCD.print(3.1456, 3);
+	measure("flush full", [](){ myLCD.flush(); });
+	myLCD.LCDGOTO(myLCD.LCDLineNumberOne, 6);
+	myLCD.print("Worms");
+	measure("flush 2 cells", [](){ myLCD.flush(); });
+	pass &= checkLine(1, "Hello Worms     ");
+	pass &= checkLine(2, "3.146           ");
+
+	myLCD.LCDShadowSet(false);
+	myLCD.LCDAsyncBegin();
+	measure("async clear + print + wait", [](){
+		myLCD.LCDClearScreen();
+		myLCD.LCDGOTO(myLCD.LCDLineNumberTwo, 0);
+		myLCD.print("Async");
+		myLCD.wait(); // barrier, sim counters are only safe to read once drained
+	});
+	std::cout << "Async high water : " << myLCD.LCDAsyncHighWaterGet() << std::endl;
+	myLCD.LCDAsyncEnd();
+	pass &= checkLine(1, "                ");
+	pass &= checkLine(2, "Async           ");
+
+	measure("LCDClearScreenCmd fixed", [](){ myLCD.LCDClearScreenCmd(); });
+	myLCD.LCDWaitModeSet(myLCD.LCDWaitTimed);
+	measure("LCDInit timed", [](){ myLCD.LCDInit(myLCD.LCDCursorTypeOn); });
+	measure("LCDClearScreenCmd timed", [](){ myLCD.LCDClearScreenCmd(); });
+	myLCD.LCDWaitModeSet(myLCD.LCDWaitBusyFlag);
+	measure("LCDInit busy flag", [](){ myLCD.LCDInit(myLCD.LCDCursorTypeOn); });
+	measure("LCDClearScreenCmd busy flag", [](){ myLCD.LCDClearScreenCmd(); });
+	mySim.SimReadWiredSet(false); // RW tied to ground, must fall back to timed
+	myLCD.LCDHome();
+	mySim.SimReadWiredSet(true);
+	if (myLCD.LCDWaitModeGet() != myLCD.LCDWaitTimed)
+	{
+		std::cout << "Error 1205: busy flag did not fall back to timed waits" << std::endl;
+		pass = false;
+	}
+	myLCD.LCDWaitModeSet(myLCD.LCDWaitDeferred);
+	measure("LCDClearScreenCmd deferred", [](){ myLCD.LCDClearScreenCmd(); });
+	if (myLCD.LCDWaitOwedUsGet() == 0 || myLCD.LCDWaitOwedUsGet() > 1520)
+	{
+		std::cout << "Error 1217: deferred wait not owed" << std::endl;
+		pass = false;
+	}
+	myLCD.LCDWaitModeSet(myLCD.LCDWaitFixed); // owed wait still paid by the next transfer
+	myLCD.print("Wait");
+	pass &= checkLine(1, "Wait            ");
+
+	uint8_t icon[8] = {0};
+	uint8_t handMade[8] = {0x15, 0x0A, 0x15, 0x0A, 0x15, 0x0A, 0x15, 0x0A};
+	myLCD.LCDCreateCustomChar(7, handMade); // reserved, the registry shares the other 7 slots
+	for (uint8_t id = 0; id < 10; id++)
+	{
+		icon[0] = id; // make each bitmap different
+		myLCD.LCDGlyphRegister(100 + id, icon);
+	}
+	myLCD.LCDGOTO(myLCD.LCDLineNumberTwo, 0);
+	measure("LCDPrintGlyph miss", [](){ myLCD.LCDPrintGlyph(100); });
+	measure("LCDPrintGlyph hit", [](){ myLCD.LCDPrintGlyph(100); });
+	for (uint8_t id = 1; id < 10; id++) myLCD.LCDPrintGlyph(100 + id); // 107 evicts 100, LRU
+	std::cout << "Glyph hits " << myLCD.LCDGlyphHitsGet() << " misses " << myLCD.LCDGlyphMissesGet() << std::endl;
+	bool handMadeKept = (mySim.SimCGRAMGet(7 * 8) == 0x15);
+	myLCD.LCDReleaseCustomChar(7);
+	if (myLCD.LCDGlyphHitsGet() != 1 || myLCD.LCDGlyphMissesGet() != 10 || mySim.SimCGRAMGet(0) != 7
+		|| !handMadeKept || myLCD.LCDGlyphLoad(100) != 7) // released slot is free
+	{
+		std::cout << "Error 1206: glyph registry LRU" << std::endl;
+		pass = false;
+	}
+
+	myLCD.LCDStatsReset();
+	myLCD.LCDStatsLatencySet(true);
+	myLCD.print("OK");
+	mySim.SimConnectedSet(false); // 1 attempt + 3 retries NACKed
+	myLCD.print("NACK");
+	mySim.SimConnectedSet(true);
+	HD44780LCDStats stats = myLCD.LCDStatsGet();
+	std::cout << "Stats : data " << stats.DataBytes << " transactions " << stats.Transactions
+		<< " retries " << stats.Retries << " failures " << stats.Failures << " NACK " << stats.ErrorsNack
+		<< " latency histogram";
+	for (uint8_t bucket = 0; bucket < HD44780LCDStats::LATENCY_BUCKETS; bucket++)
+		std::cout << " " << stats.LatencyHistogram[bucket];
+	std::cout << std::endl;
+	if (stats.DataBytes != 6 || stats.Retries != 3 || stats.Failures != 1 || stats.ErrorsNack != 4)
+	{
+		std::cout << "Error 1208: driver counters" << std::endl;
+		pass = false;
+	}
+
+	myLCD.LCDRetryPolicySet(myLCD.LCDRetryBackoff, 1, 50);
+	myLCD.LCDBreakerSet(1, 0); // open after 1 failed transfer, probe on every call while open
+	mySim.SimConnectedSet(false);
+	uint8_t status = 0;
+	measure("LCDClearScreen unplugged", [&](){ status = myLCD.LCDClearScreen(); });
+	std::cout << "Status 0x" << std::hex << +status << std::dec << " breaker open " << myLCD.LCDBreakerOpenGet() << std::endl;
+	mySim.SimConnectedSet(true);
+	pass &= (status == (myLCD.LCDStatusNack | myLCD.LCDStatusBreakerOpen));
+	pass &= (myLCD.LCDGOTO(myLCD.LCDLineNumberOne, 0) == myLCD.LCDStatusOK); // probe closes breaker
+	pass &= (myLCD.LCDBreakerOpenGet() == false);
+	myLCD.LCDBreakerSet(0);
+	myLCD.LCDRetryPolicySet(myLCD.LCDRetryFixed);
+
+	// Async mode unplugged, the worker follows the breaker instead of retrying every write
+	char asyncX[] = "X";
+	myLCD.LCDBreakerSet(2, 60000); // no probe during the test
+	myLCD.LCDAsyncBegin();
+	mySim.SimConnectedSet(false);
+	double asyncStart = mySim.SimTimeUsGet();
+	for (uint8_t i = 0; i < 10; i++) myLCD.LCDSendString(asyncX); // posted at once
+	myLCD.wait();
+	uint8_t asyncStatus = myLCD.LCDSendString(asyncX); // failures seen by the worker come back here
+	bool asyncOpen = myLCD.LCDBreakerOpenGet();
+	myLCD.wait();
+	double asyncStalledMs = (mySim.SimTimeUsGet() - asyncStart) / 1000;
+	mySim.SimConnectedSet(true);
+	myLCD.LCDBreakerSet(0);
+	myLCD.LCDAsyncEnd();
+	std::cout << "Async unplugged, worker stalled mS " << asyncStalledMs << " status 0x" << std::hex << +asyncStatus << std::dec << std::endl;
+	if (asyncStatus == 0 || !asyncOpen || asyncStalledMs > 1000) // 10 writes x 3 retries x 100mS without
+	{
+		std::cout << "Error 1227: async retry policy and breaker" << std::endl;
+		pass = false;
+	}
+
+	uint8_t arrowUp[8] = {0x04, 0x0E, 0x15, 0x04, 0x04, 0x04, 0x04, 0x00};
+	myLCD.LCDGlyphRegister(0x2191, arrowUp); // ↑ is not in the A00 ROM
+	myLCD.LCDCharsetSet(myLCD.LCDCharsetA00);
+	myLCD.LCDGOTO(myLCD.LCDLineNumberOne, 0);
+	measure("print UTF-8", [](){ myLCD.print("25°C 5µA ↑↓ ä"); });
+	myLCD.LCDCharsetSet(myLCD.LCDCharsetRaw);
+	std::string utf8Expected = "25\xDF" "C 5\xE4" "A ";
+	utf8Expected += static_cast<char>(myLCD.LCDGlyphLoad(0x2191));
+	utf8Expected += "? \xE1";
+	if (mySim.SimLineGet(1).substr(0, utf8Expected.size()) != utf8Expected)
+	{
+		std::cout << "Error 1211: UTF-8 to A00 ROM" << std::endl;
+		pass = false;
+	}
+
+	std::string news = "The quick brown fox jumps over the lazy dog"; // 43 + gap 4, longer than DDRAM line
+	myLCD.LCDMarqueeBegin(myLCD.LCDLineNumberTwo, news, 0, 4);
+	for (uint8_t step = 0; step < 59; step++) myLCD.LCDMarqueeTick();
+	measure("LCDMarqueeTick", [](){ myLCD.LCDMarqueeTick(); });
+	std::string marqueeExpected;
+	for (uint32_t pos = 60; pos < 76; pos++) marqueeExpected += (pos % 47 < news.size()) ? news[pos % 47] : ' ';
+	if (mySim.SimLineGet(2) != marqueeExpected)
+	{
+		std::cout << "Error 1212: marquee is [" << mySim.SimLineGet(2) << "] expected [" << marqueeExpected << "]" << std::endl;
+		pass = false;
+	}
+	myLCD.LCDMarqueeEnd();
+
+	myLCD.LCDGOTO(myLCD.LCDLineNumberOne, 0);
+	measure("LCDMoveCursor right 30", [](){ myLCD.LCDMoveCursor(myLCD.LCDMoveRight, 30); });
+	measure("LCDScroll left 35", [](){ myLCD.LCDScroll(myLCD.LCDMoveLeft, 35); }); // 5 right
+	myLCD.LCDScroll(myLCD.LCDMoveLeft, 5);
+	if (mySim.SimAddressCounterGet() != 30 || mySim.SimDisplayShiftGet() != 0)
+	{
+		std::cout << "Error 1213: cursor move or scroll" << std::endl;
+		pass = false;
+	}
+
+	myLCD.LCDClearScreenCmd();
+	myLCD.print("Menu page one");
+	myLCD.LCDPageBegin();
+	myLCD.LCDClearScreen(); // off screen, stale text from two flips ago
+	myLCD.LCDGOTO(myLCD.LCDLineNumberTwo, 0);
+	myLCD.print("Menu page two");
+	bool pageHidden = (mySim.SimLineGet(1) == "Menu page one   ");
+	measure("LCDPageShow page 1", [](){ myLCD.LCDPageShow(); });
+	bool pageShown = (mySim.SimLineGet(1) == "                " && mySim.SimLineGet(2) == "Menu page two   ");
+	myLCD.LCDPageBegin();
+	measure("LCDPageShow page 0", [](){ myLCD.LCDPageShow(); });
+	if (!pageHidden || !pageShown || mySim.SimLineGet(1) != "Menu page one   " || myLCD.LCDPageVisibleGet() != 0)
+	{
+		std::cout << "Error 1218: page flip" << std::endl;
+		pass = false;
+	}
+
+	// Warm start, a second driver object stands in for the restarted program
+	uint8_t bellGlyph[8] = {0x04, 0x0E, 0x0E, 0x0E, 0x1F, 0x00, 0x04, 0x00};
+	const std::string snapshot = "/tmp/hd44780_sim_16x02.snap";
+	const std::string warmLine = std::string("Warm start ") + '\0' + "    "; // bell is CGRAM 0
+	myLCD.LCDCreateCustomChar(0, bellGlyph);
+	myLCD.LCDShadowSet(true);
+	myLCD.LCDClearScreen();
+	myLCD.LCDGOTO(myLCD.LCDLineNumberOne, 0);
+	myLCD.print("Warm start ");
+	myLCD.LCDSendChar(0);
+	myLCD.flush();
+	bool saved = myLCD.LCDSnapshotSave(snapshot); // after each flush
+	myLCD.LCDShadowSet(false);
+	HD44780PCF8574LCD warmLCD(2, 16, 0x27, BCM2835_I2C_CLOCK_DIVIDER_626, mySim);
+	warmLCD.LCD_I2C_ON();
+	HD44780PCF8574LCD::LCDAttach_e attached = warmLCD.LCDAttachInit;
+	measure("LCDAttach warm", [&](){ attached = warmLCD.LCDAttach(snapshot, warmLCD.LCDCursorTypeOff); });
+	bool warmKept = (attached == warmLCD.LCDAttachWarm && mySim.SimLineGet(1) == warmLine);
+	warmLCD.LCDGOTO(warmLCD.LCDLineNumberTwo, 0);
+	warmLCD.print("Attached");
+	measure("flush after warm attach", [&](){ warmLCD.flush(); }); // only row 2
+	saved &= warmLCD.LCDSnapshotSave(snapshot);
+	mySim.SimPowerOnReset(); // display power cycled too, back in 8-bit mode and blank
+	measure("LCDAttach resync", [&](){ attached = warmLCD.LCDAttach(snapshot, warmLCD.LCDCursorTypeOff); });
+	warmLCD.flush();
+	bool resyncKept = (attached == warmLCD.LCDAttachResync && mySim.SimLineGet(1) == warmLine);
+	saved &= warmLCD.LCDSnapshotSave(snapshot);
+	const char strayNibble[2] = {0x0C, 0x08}; // command nibble 0x0, EN high then low, 4-bit interface out of step
+	mySim.I2CWrite(strayNibble, sizeof(strayNibble));
+	measure("LCDAttach out of step", [&](){ attached = warmLCD.LCDAttach(snapshot, warmLCD.LCDCursorTypeOff); });
+	warmLCD.flush();
+	warmLCD.LCDShadowSet(false);
+	std::remove(snapshot.c_str());
+	if (!saved || !warmKept || !resyncKept || mySim.SimLineGet(1) != warmLine
+		|| mySim.SimLineGet(2) != "Attached        " || mySim.SimCGRAMGet(1) != 0x0E || mySim.SimFourBitModeGet() == false)
+	{
+		std::cout << "Error 1219: warm start attach" << std::endl;
+		pass = false;
+	}
+	warmLCD.LCDGOTO(warmLCD.LCDLineNumberTwo, 8); // still in step after the resync
+	warmLCD.print("!");
+	if (attached != warmLCD.LCDAttachResync || mySim.SimLineGet(1) != warmLine || mySim.SimLineGet(2) != "Attached!       ")
+	{
+		std::cout << "Error 1223: resync from a stray nibble, line 2 is [" << mySim.SimLineGet(2) << "]" << std::endl;
+		pass = false;
+	}
+
+	// Health check, the display browns out behind the driver's back
+	const char expanderLatch = 0x08; // backlight on, EN low, as the driver leaves it
+	HD44780PCF8574LCD::LCDHealth_e health[3];
+	myLCD.LCDStatsReset();
+	myLCD.LCDGOTO(myLCD.LCDLineNumberOne, 0); // warmLCD moved the address counter behind its back
+	myLCD.LCDHealthSet(60000); // only failed transfers and explicit checks trigger it here
+	myLCD.LCDShadowSet(true);
+	myLCD.LCDClearScreen();
+	myLCD.LCDGOTO(myLCD.LCDLineNumberOne, 0);
+	myLCD.print("Health ");
+	myLCD.LCDSendChar(0);
+	myLCD.flush();
+	measure("LCDHealthCheck healthy", [&](){ health[0] = myLCD.LCDHealthCheck(); });
+	mySim.SimPowerOnReset(); // HD44780 resets, the PCF8574 rides through and keeps its latch
+	mySim.I2CWrite(&expanderLatch, 1);
+	measure("LCDHealthCheck controller reset", [&](){ health[1] = myLCD.LCDHealthCheck(); });
+	mySim.SimConnectedSet(false); // unplugged, the flush fails
+	myLCD.LCDGOTO(myLCD.LCDLineNumberTwo, 0);
+	myLCD.print("Replayed");
+	myLCD.flush();
+	mySim.SimPowerOnReset(); // plugged back in, PCF8574 pins all high, HD44780 8-bit mode, RAM blank
+	mySim.SimConnectedSet(true);
+	measure("flush after power cycle", [](){ myLCD.flush(); }); // check runs first after a failed transfer
+	health[2] = myLCD.LCDHealthCheck();
+	myLCD.LCDShadowSet(false);
+	myLCD.LCDHealthSet(0);
+	stats = myLCD.LCDStatsGet();
+	std::cout << "Health checks " << stats.HealthChecks << " recoveries " << stats.HealthRecoveries
+		<< " last recovery uS " << stats.RecoveryLastUs << " max uS " << stats.RecoveryMaxUs << std::endl;
+	if (health[0] != myLCD.LCDHealthOK || health[1] != myLCD.LCDHealthRecovered || health[2] != myLCD.LCDHealthOK
+		|| stats.HealthRecoveries != 2 || mySim.SimLineGet(1) != std::string("Health ") + '\0' + "        "
+		|| mySim.SimLineGet(2) != "Replayed        " || mySim.SimCGRAMGet(1) != 0x0E || mySim.SimFourBitModeGet() == false)
+	{
+		std::cout << "Error 1220: health check recovery" << std::endl;
+		pass = false;
+	}
+
+	// Health check, the 4-bit interface a nibble out of step, the address counter unchanged
+	HD44780TransportSimFlaky straySim(2, 16, 0x27);
+	HD44780PCF8574LCD strayLCD(2, 16, 0x27, BCM2835_I2C_CLOCK_DIVIDER_626, straySim);
+	HD44780PCF8574LCD::LCDHealth_e strayHealth[4];
+	bool strayArmed = true;
+	strayLCD.LCD_I2C_ON();
+	strayLCD.LCDInit(strayLCD.LCDCursorTypeOff);
+	strayLCD.LCDI2CErrorRetryNumSet(0);
+	strayLCD.LCDHealthSet(60000);
+	strayLCD.LCDShadowSet(true);
+	strayLCD.LCDGOTO(strayLCD.LCDLineNumberOne, 0);
+	strayLCD.print("Stray nibble");
+	strayLCD.flush();
+	straySim.I2CWrite(strayNibble, sizeof(strayNibble)); // no failed transfer, only the read back finds it
+	strayHealth[0] = strayLCD.LCDHealthCheck();
+	strayLCD.LCDGOTO(strayLCD.LCDLineNumberTwo, 0);
+	strayLCD.print("Half sent");
+	straySim.FailWrite = 1;
+	straySim.FailLatched = 2; // the first nibble reaches the display before the NACK
+	strayLCD.flush();
+	strayHealth[1] = strayLCD.LCDHealthCheck();
+	if (strayHealth[0] != strayLCD.LCDHealthRecovered || strayHealth[1] != strayLCD.LCDHealthRecovered
+		|| straySim.SimLineGet(1) != "Stray nibble    " || straySim.SimLineGet(2) != "Half sent       ")
+	{
+		std::cout << "Error 1224: stray nibble, health check missed it" << std::endl;
+		pass = false;
+	}
+	straySim.SimExecuteHookSet([&](uint8_t value, bool data) // out of step again straight after the resync
+	{
+		if (strayArmed == false || data == true || value != 0x02) return; // home ends LCDResync
+		strayArmed = false;
+		straySim.StrayWrite = 1;
+	});
+	straySim.I2CWrite(strayNibble, sizeof(strayNibble));
+	strayHealth[2] = strayLCD.LCDHealthCheck();
+	straySim.SimExecuteHookSet(nullptr);
+	strayHealth[3] = strayLCD.LCDHealthCheck();
+	strayLCD.LCDShadowSet(false);
+	strayLCD.LCDGOTO(strayLCD.LCDLineNumberTwo, 10);
+	strayLCD.print("!"); // in step from here on
+	if (strayHealth[2] != strayLCD.LCDHealthLost || strayHealth[3] != strayLCD.LCDHealthRecovered
+		|| straySim.SimLineGet(1) != "Stray nibble    " || straySim.SimLineGet(2) != "Half sent !     ")
+	{
+		std::cout << "Error 1225: recovery not read back, line 2 is [" << straySim.SimLineGet(2) << "]" << std::endl;
+		pass = false;
+	}
+
+	// A write NACKed part way, the frames before the NACK already latched, then retried
+	HD44780TransportSimFlaky partSim(2, 16, 0x27);
+	HD44780PCF8574LCD partLCD(2, 16, 0x27, BCM2835_I2C_CLOCK_DIVIDER_626, partSim);
+	char partHello[] = "Hello";
+	char partBang[] = "!";
+	partLCD.LCD_I2C_ON();
+	partLCD.LCDInit(partLCD.LCDCursorTypeOff);
+	partLCD.LCDGOTO(partLCD.LCDLineNumberOne, 0);
+	partSim.FailWrite = 1;
+	partSim.FailLatched = 12; // "Hel" reaches the display
+	uint8_t partStatus = partLCD.LCDSendString(partHello);
+	partStatus |= partLCD.LCDSendString(partBang);
+	bool partDirect = (partStatus == 0 && partSim.SimLineGet(1) == "Hello!          ");
+	partLCD.LCDShadowSet(true);
+	partLCD.LCDGOTO(partLCD.LCDLineNumberTwo, 0);
+	partLCD.print("Shadow");
+	partSim.FailWrite = 1;
+	partSim.FailLatched = 12; // the set address and two blanks of line 1
+	partLCD.flush(); // every cell, the shadow buffer starts blank
+	partLCD.print("ed");
+	partLCD.flush(); // only the new cells
+	partLCD.LCDShadowSet(false);
+	if (!partDirect || partSim.SimLineGet(1) != "                " || partSim.SimLineGet(2) != "Shadowed        ")
+	{
+		std::cout << "Error 1226: partial write retried, lines are [" << partSim.SimLineGet(1) << "] ["
+			<< partSim.SimLineGet(2) << "]" << std::endl;
+		pass = false;
+	}
+	partLCD.LCDAsyncBegin(); // the worker retries, with the same set address first
+	partLCD.LCDGOTO(partLCD.LCDLineNumberOne, 0);
+	partLCD.wait(); // worker idle, safe to arm the failure
+	partSim.FailWrite = 1;
+	partSim.FailLatched = 12;
+	partLCD.LCDSendString(partHello);
+	partLCD.LCDSendString(partBang);
+	partLCD.LCDAsyncEnd();
+	if (partSim.SimLineGet(1) != "Hello!          ")
+	{
+		std::cout << "Error 1228: async partial write retried, line 1 is [" << partSim.SimLineGet(1) << "]" << std::endl;
+		pass = false;
+	}
+
+	// The largest ring asked for, filled while the bus is stalled, depth fits the uint16_t getters
+	uint16_t fullDepth = 0;
+	{
+		HD44780TransportAsync fullRing(partSim, 65535);
+		const char fullFrame[1] = {0x08};
+		partSim.Hold = true;
+		std::thread release([&](){
+			std::this_thread::sleep_for(std::chrono::milliseconds(300));
+			fullDepth = fullRing.AsyncDepthGet();
+			partSim.Hold = false; });
+		for (uint32_t i = 0; i < 40000; i++) fullRing.I2CWrite(fullFrame, 1); // blocks once full
+		release.join();
+		fullRing.AsyncWait();
+		if (fullDepth != 32768 || fullRing.AsyncHighWaterGet() != 32768)
+		{
+			std::cout << "Error 1229: full ring depth " << fullDepth << " high water "
+				<< fullRing.AsyncHighWaterGet() << std::endl;
+			pass = false;
+		}
+	}
+
+	// Shadow mode cursor moved left past column 0 stops there
+	HD44780TransportSim moveSim(2, 16, 0x27);
+	HD44780PCF8574LCD moveLCD(2, 16, 0x27, BCM2835_I2C_CLOCK_DIVIDER_626, moveSim);
+	moveLCD.LCD_I2C_ON();
+	moveLCD.LCDInit(moveLCD.LCDCursorTypeOff);
+	moveLCD.LCDShadowSet(true);
+	moveLCD.LCDGOTO(moveLCD.LCDLineNumberTwo, 1);
+	moveLCD.LCDMoveCursor(moveLCD.LCDMoveLeft, 3);
+	moveLCD.print("AB");
+	moveLCD.flush();
+	moveLCD.LCDShadowSet(false);
+	if (moveSim.SimLineGet(2) != "AB              ")
+	{
+		std::cout << "Error 1230: shadow move left, line 2 is [" << moveSim.SimLineGet(2) << "]" << std::endl;
+		pass = false;
+	}
+
+	static_assert(HD44780LCD<1, 16>::CellAddress(0, 8) == 0x40, "16x1 split addressing");
+	HD44780TransportSim splitSim(1, 16, 0x27);
+	HD44780LCD<1, 16> splitLCD(0x27, 0, splitSim);
+	splitLCD.LCD_I2C_ON();
+	splitLCD.LCDInit(splitLCD.LCDCursorTypeOff);
+	splitLCD.LCDShadowSet(true);
+	splitLCD.LCDGOTO(splitLCD.LCDLineNumberOne, 0);
+	splitLCD.print("Split Addressing");
+	splitLCD.flush();
+	splitLCD.LCDGOTO(splitLCD.LCDLineNumberOne, 6);
+	splitLCD.print("  A");
+	splitLCD.flush(); // run crosses column 8
+	splitLCD.LCDShadowSet(false);
+	if (splitSim.SimLineGet(1) != "Split   Aressing")
+	{
+		std::cout << "Error 1209: 16x1 is [" << splitSim.SimLineGet(1) << "]" << std::endl;
+		pass = false;
+	}
+
+	// 20x4 repaint is over LCD_BATCH_MAX bytes, the first of its transfers is lost
+	HD44780TransportSimFlaky bigSim(4, 20, 0x27);
+	HD44780PCF8574LCD bigLCD(4, 20, 0x27, BCM2835_I2C_CLOCK_DIVIDER_626, bigSim);
+	bigLCD.LCD_I2C_ON();
+	bigLCD.LCDInit(bigLCD.LCDCursorTypeOff);
+	bigLCD.LCDI2CErrorRetryNumSet(0);
+	bigLCD.LCDShadowSet(true);
+	for (uint8_t row = 0; row < 4; row++)
+	{
+		bigLCD.LCDGOTO(static_cast<HD44780PCF8574LCD::LCDLineNumber_e>(row + 1), 0);
+		bigLCD.print("Row " + std::to_string(row + 1) + " of twenty x 4.");
+	}
+	bigLCD.LCDShadowCursorSet(true); // 80 cells + set address, two transfers
+	bigLCD.LCDGOTO(bigLCD.LCDLineNumberTwo, 5);
+	bigSim.FailWrite = 1;
+	bigLCD.flush();
+	bool bigFailed = (bigSim.SimLineGet(1) != "Row 1 of twenty x 4.");
+	bigLCD.flush(); // nothing changed since, but the lost cells are sent again
+	bigLCD.LCDShadowSet(false);
+	if (!bigFailed || bigSim.SimLineGet(1) != "Row 1 of twenty x 4." || bigSim.SimLineGet(4) != "Row 4 of twenty x 4.")
+	{
+		std::cout << "Error 1221: flush failed part way" << std::endl;
+		pass = false;
+	}
+
+	HD44780PCF8574LCD wideLCD(4, 40, 0x27, BCM2835_I2C_CLOCK_DIVIDER_626, bigSim); // 160 cells, two controllers
+	if (wideLCD.LCDShadowSet(true) == true || wideLCD.LCDShadowGet() == true)
+	{
+		std::cout << "Error 1222: shadow mode accepted over 80 cells" << std::endl;
+		pass = false;
+	}
+
+	std::cout << mySim.SimScreenGet() << std::endl;
+	std::cout << "Busy violations : " << mySim.SimStatsGet().BusyViolations << std::endl;
+	std::cout << "LCD Simulation End " << (pass ? "PASS" : "FAIL") << std::endl;
+	return pass ? 0 : 1;
+} // End of main
+
+// Section :  Functions
+
+// Run one API call and print bus transactions, bytes, modelled bus time and wall time
+void measure(const char *name, std::function<void(void)> apiCall)
+{
+	mySim.SimStatsReset();
+	auto start = std::chrono::steady_clock::now();
+	apiCall();
+	auto wall = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+	HD44780SimStats stats = mySim.SimStatsGet();
+	std::cout << name << " : transactions " << stats.Transactions << " bytes " << stats.BytesWritten
+		<< " bus uS " << stats.BusTimeUs << " delay uS " << stats.DelayTimeUs
+		<< " wall uS " << wall << std::endl;
+}
+
+// Compare one emulated line with the expected text
+bool checkLine(uint8_t lineNo, const std::string &expected)
+{
+	std::string actual = mySim.SimLineGet(lineNo);
+	if (actual == expected) return true;
+	std::cout << "Error 1203: line " << +lineNo << " is [" << actual << "] expected [" << expected << "]" << std::endl;
+	return false;
+}
+
+// *** EOF ***
@@ -0,0 +1,197 @@
+/*!
+	@file main.cpp
+	@author   Gavin Lyons
+	@brief  This file contains the "main" function for the bus trace replay tool.
+		Feeds a trace written by HD44780TransportRecord into the simulated display,
+		and optionally onto real hardware, prints the decoded command stream,
+		the final screen and the bus counters.
+	@note
+	-# Usage : ./bin/test trace.bin [rows cols] [-realtime] [-hw] [-quiet]
+	-# ./bin/test -demo trace.bin , records a short session on the simulator then replays it,
+		with no arguments as -demo trace.bin
+	-# -realtime keeps the recorded timing, default is as fast as possible(delays kept for -hw)
+	-# -hw also replays onto the bcm2835 I2C bus, needs root
+	-# Record in your own program with
+		HD44780TransportBCM2835 myBus; HD44780TransportRecord myRecorder(myBus);
+		HD44780PCF8574LCD myLCD(2, 16, 0x27, 0, myRecorder); myRecorder.RecordOpen("trace.bin");
+*/
+
+// Section: Included library
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <cstring>
+#include <bcm2835.h>
+#include "HD44780_LCD.hpp"
+#include "HD44780_LCD_Sim.hpp"
+#include "HD44780_LCD_Trace.hpp"
+
+// Section: Globals
+uint64_t TraceTimeUs = 0; // time of the record being replayed, for the decoded stream
+bool Quiet = false;
+
+// Section: Function Prototypes
+bool recordDemo(const std::string &path);
+void printDecoded(uint8_t value, bool data);
+
+// Section: Main Loop
+
+int main(int argc, char **argv)
+{
+	std::string path;
+	uint8_t rows = 2, cols = 16;
+	bool realTime = false, hardware = false;
+	for (int arg = 1; arg < argc; arg++)
+	{
+		if (strcmp(argv[arg], "-realtime") == 0) realTime = true;
+		else if (strcmp(argv[arg], "-hw") == 0) hardware = true;
+		else if (strcmp(argv[arg], "-quiet") == 0) Quiet = true;
+		else if (strcmp(argv[arg], "-demo") == 0 && arg + 1 < argc)
+		{
+			path = argv[++arg];
+			if (!recordDemo(path)) return 1;
+		}
+		else if (path.empty()) path = argv[arg];
+		else if (arg + 1 < argc)
+		{
+			rows = atoi(argv[arg]);
+			cols = atoi(argv[++arg]);
+		}
+	}
+	if (path.empty())
+	{
+		path = "trace.bin";
+		if (!recordDemo(path)) return 1;
+	}
+
+	HD44780TraceReader reader;
+	if (!reader.TraceOpen(path))
+	{
+		std::cout << "Error 1214: " << path << " is not a trace file" << std::endl;
+		return 1;
+	}
+	if (hardware && !bcm2835_init())
+	{
+		std::cout << "Error 1201: init bcm2835 library , Is it installed ?" << std::endl;
+		return 1;
+	}
+
+	HD44780TransportSim sim(rows, cols, 0x27);
+	HD44780TransportBCM2835 bus;
+	sim.SimExecuteHookSet(printDecoded);
+	sim.SimStatsReset();
+
+	HD44780TraceRecord record;
+	uint32_t count = 0, failures = 0;
+	auto start = std::chrono::steady_clock::now();
+	while (reader.TraceNext(record))
+	{
+		count++;
+		TraceTimeUs = record.TimeUs;
+		if (realTime) std::this_thread::sleep_until(start + std::chrono::microseconds(record.TimeUs));
+		switch (record.Type)
+		{
+			case HD44780TraceBegin:
+				sim.I2CBegin();
+				if (hardware) bus.I2CBegin();
+			break;
+			case HD44780TraceEnd:
+				if (hardware) bus.I2CEnd();
+			break;
+			case HD44780TraceSpeed:
+				sim.I2CSpeedSet(record.Value);
+				if (hardware) bus.I2CSpeedSet(record.Value);
+			break;
+			case HD44780TraceAddress:
+				sim.I2CAddressSet(0x27); // the simulated display answers whatever was recorded
+				if (hardware) bus.I2CAddressSet(record.Value);
+			break;
+			case HD44780TraceWrite:
+				if (record.Result != BCM2835_I2C_REASON_OK) failures++; // recorded failure, display may have seen part of it
+				sim.I2CWrite(record.Bytes.data(), record.Bytes.size());
+				if (hardware) bus.I2CWrite(record.Bytes.data(), record.Bytes.size());
+			break;
+			case HD44780TraceRead:
+				sim.I2CRead(&record.Bytes[0], record.Bytes.size());
+				if (hardware) bus.I2CRead(&record.Bytes[0], record.Bytes.size());
+			break;
+			case HD44780TraceDelay:
+				sim.DelayUs(record.Value);
+				if (hardware && !realTime) bus.DelayUs(record.Value);
+			break;
+		}
+	}
+	reader.TraceClose();
+	if (hardware) bcm2835_close();
+
+	HD44780SimStats stats = sim.SimStatsGet();
+	std::cout << "Records " << count << " , recorded time uS " << TraceTimeUs
+		<< " , failed writes " << failures << std::endl;
+	std::cout << "Transactions " << stats.Transactions << " , bytes " << stats.BytesWritten
+		<< " , commands " << stats.Commands << " , data " << stats.DataWrites
+		<< " , bus uS " << stats.BusTimeUs << " , delay uS " << stats.DelayTimeUs
+		<< " , busy violations " << stats.BusyViolations << std::endl;
+	std::cout << "Final screen :" << std::endl << sim.SimScreenGet() << std::endl;
+	return 0;
+} // End of main
+
+// Section :  Functions
+
+// Record a short session on the simulator, as a field unit would on real hardware
+bool recordDemo(const std::string &path)
+{
+	HD44780TransportSim sim(2, 16, 0x27);
+	HD44780TransportRecord recorder(sim);
+	HD44780PCF8574LCD myLCD(2, 16, 0x27, BCM2835_I2C_CLOCK_DIVIDER_626, recorder);
+	if (!recorder.RecordOpen(path))
+	{
+		std::cout << "Error 1207: cannot open " << path << std::endl;
+		return false;
+	}
+	char teststr1[] = "Hello";
+	myLCD.LCD_I2C_ON();
+	myLCD.LCDInit(myLCD.LCDCursorTypeOn);
+	myLCD.LCDClearScreen();
+	myLCD.LCDGOTO(myLCD.LCDLineNumberOne, 0);
+	myLCD.LCDSendString(teststr1);
+	myLCD.LCDGOTO(myLCD.LCDLineNumberTwo, 0);
+	myLCD.print(3.1456, 3);
+	myLCD.LCD_I2C_OFF();
+	std::cout << "Recorded " << recorder.RecordCountGet() << " records to " << path << std::endl;
+	recorder.RecordClose();
+	return true;
+}
+
+// Print one byte received by the emulated HD44780 as a decoded instruction
+void printDecoded(uint8_t value, bool data)
+{
+	if (Quiet) return;
+	std::cout << std::setw(10) << TraceTimeUs << " uS  0x" << std::hex << std::setw(2)
+		<< std::setfill('0') << +value << std::dec << std::setfill(' ') << "  ";
+	if (data)
+		std::cout << "Data '" << ((value >= 0x20 && value < 0x7F) ? static_cast<char>(value) : '.') << "'";
+	else if (value & 0x80)
+		std::cout << "Set DDRAM address 0x" << std::hex << (value & 0x7F) << std::dec;
+	else if (value & 0x40)
+		std::cout << "Set CGRAM address 0x" << std::hex << (value & 0x3F) << std::dec;
+	else if (value & 0x20)
+		std::cout << "Function set " << ((value & 0x10) ? "8" : "4") << "-bit "
+			<< ((value & 0x08) ? "2" : "1") << " line";
+	else if (value & 0x10)
+		std::cout << ((value & 0x08) ? "Display shift " : "Cursor shift ") << ((value & 0x04) ? "right" : "left");
+	else if (value & 0x08)
+		std::cout << "Display control display " << ((value & 0x04) ? "on" : "off") << " cursor "
+			<< ((value & 0x02) ? "on" : "off") << " blink " << ((value & 0x01) ? "on" : "off");
+	else if (value & 0x04)
+		std::cout << "Entry mode " << ((value & 0x02) ? "increment" : "decrement")
+			<< ((value & 0x01) ? " shift" : "");
+	else if (value & 0x02)
+		std::cout << "Return home";
+	else if (value & 0x01)
+		std::cout << "Clear display";
+	else
+		std::cout << "(no operation)";
+	std::cout << std::endl;
+}
+
+// *** EOF ***
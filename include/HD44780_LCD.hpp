@@ -7,10 +7,43 @@
 
 #include <bcm2835.h>
 #include <iostream> // for cout error messages
+#include <chrono>
 #include "HD44780_LCD_Print.hpp"
+#include "HD44780_LCD_Transport.hpp"
+#include "HD44780_LCD_Async.hpp"
+#include "HD44780_LCD_Frames.hpp"
+#include "HD44780_LCD_Geometry.hpp"
+#include "HD44780_LCD_Charset.hpp"
 
 #pragma once
 
+// Section: Structs
+
+/*!
+	@brief Driver counters of one HD44780PCF8574LCD, see LCDStatsGet
+*/
+struct HD44780LCDStats {
+	static const uint8_t LATENCY_BUCKETS = 16; /**< Number of latency histogram buckets */
+	uint32_t Commands = 0; /**< Command bytes sent */
+	uint32_t DataBytes = 0; /**< Data bytes sent */
+	uint32_t Transactions = 0; /**< I2C transfers, first attempts + retries + busy flag reads */
+	uint32_t BytesWritten = 0; /**< PCF8574 frame bytes written, 4 per LCD byte */
+	uint32_t Retries = 0; /**< Retransmits after a failed write */
+	uint32_t Failures = 0; /**< Writes still failed after all retries */
+	uint32_t ErrorsNack = 0; /**< Failed attempts, BCM2835_I2C_REASON_ERROR_NACK */
+	uint32_t ErrorsClkt = 0; /**< Failed attempts, BCM2835_I2C_REASON_ERROR_CLKT */
+	uint32_t ErrorsData = 0; /**< Failed attempts, BCM2835_I2C_REASON_ERROR_DATA */
+	uint32_t ErrorsTimeout = 0; /**< Failed attempts, BCM2835_I2C_REASON_ERROR_TIMEOUT */
+	uint32_t BreakerTrips = 0; /**< Times the circuit breaker opened */
+	uint32_t BreakerRejects = 0; /**< Transfers not sent because the circuit breaker was open */
+	uint32_t HealthChecks = 0; /**< Connection health checks that reached the bus */
+	uint32_t HealthRecoveries = 0; /**< Controller resets found and recovered by the health check */
+	uint32_t RecoveryLastUs = 0; /**< Time of the last recovery, re-init + CGRAM + screen replay uS */
+	uint32_t RecoveryMaxUs = 0; /**< Longest recovery uS */
+	uint32_t LatencyHistogram[LATENCY_BUCKETS] = {0}; /**< Transfer time incl. retries, bucket 0 < 2uS, bucket n 2^n to 2^(n+1)-1 uS, last bucket and over */
+	uint32_t LatencyMaxUs = 0; /**< Longest transfer uS */
+	uint64_t LatencyTotalUs = 0; /**< Sum of transfer times uS */
+};
 
 // Section: Class's
 class HD44780PCF8574LCD : public Print{ 
@@ -45,6 +78,63 @@ class HD44780PCF8574LCD : public Print{
 		LCDMoveLeft = 2   /**< move or scroll left */
 	}; 
 
+	/*! I2C bus interface selected in constructor */
+	enum LCDBusType_e : uint8_t {
+		LCDBusBCM2835 = 0, /**< bcm2835 library, needs root, RPI only, default */
+		LCDBusI2CDev = 1 /**< Linux kernel /dev/i2c-N, i2c group, any board */
+	};
+
+	/*! Status returned by the drawing methods, bits may be OR'ed when a method makes several transfers */
+	enum LCDStatus_e : uint8_t{
+		LCDStatusOK = 0x00, /**< Success, BCM2835_I2C_REASON_OK */
+		LCDStatusNack = 0x01, /**< BCM2835_I2C_REASON_ERROR_NACK, Received a NACK */
+		LCDStatusClkt = 0x02, /**< BCM2835_I2C_REASON_ERROR_CLKT, Received Clock Stretch Timeout */
+		LCDStatusData = 0x04, /**< BCM2835_I2C_REASON_ERROR_DATA, Not all data is sent */
+		LCDStatusTimeout = 0x08, /**< BCM2835_I2C_REASON_ERROR_TIMEOUT, Time out occurred during sending */
+		LCDStatusBreakerOpen = 0x10 /**< Not sent, circuit breaker open after repeated failures */
+	};
+
+	/*! Delay between retry attempts of a failed transfer */
+	enum LCDRetryPolicy_e : uint8_t{
+		LCDRetryFixed = 0, /**< LCDI2CErrorTimeoutSet delay before every retry, default */
+		LCDRetryBackoff = 1 /**< First retry immediate, then exponential backoff with jitter */
+	};
+
+	/*! How flush() orders and addresses the changed cells */
+	enum LCDFlushPlan_e : uint8_t{
+		LCDFlushPerRun = 0, /**< Row by row, a set address command before every run of changed cells */
+		LCDFlushCostModel = 1 /**< DDRAM order, short gaps re-sent when cheaper than a set address, default */
+	};
+
+	/*! How text bytes are turned into HD44780 character codes */
+	enum LCDCharset_e : uint8_t{
+		LCDCharsetRaw = 0, /**< Bytes sent as is, default */
+		LCDCharsetA00 = 1, /**< UTF-8 text, mapped to the A00 Japanese character ROM */
+		LCDCharsetA02 = 2 /**< UTF-8 text, mapped to the A02 European character ROM */
+	};
+
+	/*! How the driver waits for slow commands to finish */
+	enum LCDWaitMode_e : uint8_t{
+		LCDWaitFixed = 0, /**< Fixed mS delays as version 1.3.x, default */
+		LCDWaitTimed = 1, /**< Datasheet execution times in uS */
+		LCDWaitBusyFlag = 2, /**< Poll the HD44780 busy flag, needs RW wired to PCF8574 P1 */
+		LCDWaitDeferred = 3 /**< Datasheet times, owed until the next transfer, see LCDWaitOwedUsGet */
+	};
+
+	/*! How LCDAttach took over the display */
+	enum LCDAttach_e : uint8_t{
+		LCDAttachWarm = 0, /**< Controller found in 4-bit mode, nothing reset, snapshot taken as the screen contents */
+		LCDAttachResync = 1, /**< Controller state unknown, interface resynchronised without a clear, snapshot redrawn in place */
+		LCDAttachInit = 2 /**< No usable snapshot, LCDInit done */
+	};
+
+	/*! Result of a connection health check, see LCDHealthCheck */
+	enum LCDHealth_e : uint8_t{
+		LCDHealthOK = 0, /**< Display answered, nothing found wrong */
+		LCDHealthRecovered = 1, /**< Controller reset or out of step, re-initialised and state replayed */
+		LCDHealthLost = 2 /**< No answer, breaker open or still out of step after re-initialising, tried again at the next tick */
+	};
+
 	/*! Line Row Number */
 	enum LCDLineNumber_e : uint8_t{
 		LCDLineNumberOne = 1,   /**< row 1 */
@@ -55,11 +145,16 @@ class HD44780PCF8574LCD : public Print{
 	
 	
 	HD44780PCF8574LCD(uint8_t NumRow, uint8_t NumCol, uint8_t I2Caddress, uint16_t I2Cspeed);
+	HD44780PCF8574LCD(uint8_t NumRow, uint8_t NumCol, uint8_t I2Caddress, uint16_t I2Cspeed, HD44780Transport &transport);
+	HD44780PCF8574LCD(uint8_t NumRow, uint8_t NumCol, uint8_t I2Caddress, uint16_t I2Cspeed, LCDBusType_e busType, uint8_t busNumber = 1);
 	~HD44780PCF8574LCD(){};
 	
-	void LCDInit(LCDCursorType_e);
-	void LCDDisplayON(bool);
-	void LCDResetScreen(LCDCursorType_e);
+	uint8_t LCDInit(LCDCursorType_e);
+	uint8_t LCDDisplayON(bool);
+	uint8_t LCDResetScreen(LCDCursorType_e);
+	LCDAttach_e LCDAttach(const std::string &snapshotPath, LCDCursorType_e CursorType);
+	bool LCDSnapshotSave(const std::string &snapshotPath);
+	uint8_t LCDCursorTypeSet(LCDCursorType_e);
 	
 	void LCDBackLightSet(bool);
 	bool LCDBackLightGet(void);
@@ -71,56 +166,171 @@ class HD44780PCF8574LCD : public Print{
 	void LCD_I2C_OFF(void);
 	uint8_t LCDCheckConnection(void);
 	uint8_t LCDI2CErrorGet(void);
+	uint8_t LCDI2CAddressGet(void);
+	uint8_t LCDRowsGet(void);
+	uint8_t LCDColsGet(void);
 	uint16_t LCDI2CErrorTimeoutGet(void);
 	void LCDI2CErrorTimeoutSet(uint16_t);
 	uint8_t LCDI2CErrorRetryNumGet(void);
 	void LCDI2CErrorRetryNumSet(uint8_t);
 	bool LCDDebugGet(void);
 	void LCDDebugSet(bool);
+	bool LCDShadowGet(void);
+	bool LCDShadowDirtyGet(void);
+	bool LCDShadowSet(bool);
+	void LCDShadowCursorSet(bool);
+	virtual void flush();
+	void LCDFlushPlanSet(LCDFlushPlan_e plan);
+	LCDFlushPlan_e LCDFlushPlanGet(void);
+	void LCDRetryPolicySet(LCDRetryPolicy_e policy, uint16_t baseDelayMs = 1, uint16_t maxDelayMs = 50);
+	LCDRetryPolicy_e LCDRetryPolicyGet(void);
+	void LCDBreakerSet(uint8_t failureThreshold, uint32_t probeIntervalMs = 1000);
+	bool LCDBreakerOpenGet(void);
+	void LCDHealthSet(uint32_t intervalMs);
+	uint32_t LCDHealthGet(void);
+	LCDHealth_e LCDHealthCheck(void);
+	bool LCDHealthTick(void);
+	HD44780LCDStats LCDStatsGet(void);
+	void LCDStatsReset(void);
+	void LCDStatsLatencySet(bool);
+	void LCDWaitModeSet(LCDWaitMode_e mode);
+	LCDWaitMode_e LCDWaitModeGet(void);
+	uint32_t LCDWaitOwedUsGet(void);
+
+	bool LCDAsyncBegin(uint16_t ringSize = 256);
+	void LCDAsyncEnd(void);
+	bool LCDAsyncGet(void);
+	void wait(void);
+	uint16_t LCDAsyncHighWaterGet(void);
+	void LCDAsyncHighWaterReset(void);
+	uint32_t LCDAsyncErrorCountGet(void);
 
-	void LCDSendString (char *str);
-	void LCDSendChar (char data);
+	uint8_t LCDSendString (char *str);
+	uint8_t LCDSendChar (char data);
+	void LCDCharsetSet(LCDCharset_e charset, uint8_t replacement = '?');
+	LCDCharset_e LCDCharsetGet(void);
+	using Print::write;
 	virtual size_t write(uint8_t);
-	void LCDCreateCustomChar(uint8_t location, uint8_t* charmap);
-	void LCDPrintCustomChar(uint8_t location);
+	virtual size_t write(const uint8_t *buffer, size_t size);
+	uint8_t LCDCreateCustomChar(uint8_t location, uint8_t* charmap);
+	void LCDReleaseCustomChar(uint8_t location);
+	uint8_t LCDPrintCustomChar(uint8_t location);
+	bool LCDGlyphRegister(uint16_t glyphID, const uint8_t *charmap);
+	int8_t LCDGlyphLoad(uint16_t glyphID);
+	bool LCDPrintGlyph(uint16_t glyphID);
+	void LCDGlyphInvalidate(void);
+	uint32_t LCDGlyphHitsGet(void);
+	uint32_t LCDGlyphMissesGet(void);
+	void LCDGlyphStatsReset(void);
 	
-	void LCDMoveCursor(LCDDirectionType_e, uint8_t moveSize);
-	void LCDScroll(LCDDirectionType_e, uint8_t ScrollSize);
-	void LCDGOTO(LCDLineNumber_e  lineNo, uint8_t  col);
-	void LCDClearLine (LCDLineNumber_e lineNo);
-	void LCDClearScreen(void);
-	void LCDClearScreenCmd(void);
-	void LCDHome(void);
-	void LCDChangeEntryMode(LCDEntryMode_e mode);
+	uint8_t LCDMoveCursor(LCDDirectionType_e, uint8_t moveSize);
+	uint8_t LCDScroll(LCDDirectionType_e, uint8_t ScrollSize);
+	uint8_t LCDGOTO(LCDLineNumber_e  lineNo, uint8_t  col);
+	uint8_t LCDClearLine (LCDLineNumber_e lineNo);
+	uint8_t LCDClearScreen(void);
+	uint8_t LCDClearScreenCmd(void);
+	uint8_t LCDHome(void);
+	uint8_t LCDChangeEntryMode(LCDEntryMode_e mode);
+
+	bool LCDMarqueeBegin(LCDLineNumber_e line, const std::string &text, uint16_t stepMs = 300, uint8_t gap = 4);
+	bool LCDMarqueeTick(void);
+	void LCDMarqueeEnd(void);
+	bool LCDMarqueeGet(void);
+
+	bool LCDPageBegin(void);
+	uint8_t LCDPageShow(void);
+	uint8_t LCDPageVisibleGet(void);
+
+  protected:
+	uint8_t LCDGOTOAddress(uint8_t row, uint8_t col, uint8_t address);
 
   private:
-	void LCDSendCmd (unsigned char cmd);
-	void LCDSendData (unsigned char data);
+	uint8_t LCDSendCmd (unsigned char cmd);
+	uint8_t LCDSendData (unsigned char data);
+	void LCDBatchCmd(uint8_t cmd);
+	void LCDBatchData(uint8_t data);
+	void LCDBatchFrames(uint8_t value, bool data);
+	void LCDBatchDataRun(const uint8_t *data, size_t length);
+	uint8_t LCDBatchSend(void);
+	void LCDBatchAddress(uint8_t cmd);
+	void LCDBatchMark(void);
+	void LCDWaitReady(uint16_t fixedMs, uint16_t execUs, bool pollable = true);
+	bool LCDBusyFlagPoll(void);
+	bool LCDReadStatus(uint8_t &status);
+	uint8_t LCDResync(void);
+	uint8_t LCDSendNibble(uint8_t nibble);
+	bool LCDAttachProbe(uint8_t &status);
+	bool LCDHealthProbe(bool &verified);
+	void LCDHealthRecover(bool powerCycled);
+	void LCDWaitPay(void);
+	void LCDStatsError(uint8_t reasonCode);
+	uint16_t LCDRetryDelay(uint8_t retry);
+	bool LCDBreakerProbe(void);
+	void LCDBreakerFailure(void);
+	void LCDBreakerTrip(void);
+	uint8_t LCDAsyncStatus(void);
+	void LCDAsyncPolicySet(void);
+	void LCDTrackCmd(uint8_t cmd);
+	void LCDTrackData(size_t count);
+	uint8_t LCDAddressStep(uint8_t address, bool increment);
+	uint8_t LCDCellAddress(uint8_t row, uint8_t col);
+	int8_t LCDGlyphIndexOf(uint16_t glyphID);
+	int8_t LCDGlyphVictim(void);
+	bool LCDGlyphVisible(uint8_t slot);
+	void LCDShadowWrite(uint8_t data);
+	void LCDShadowFill(uint8_t row);
+	void LCDFlushPerRunPlan(void);
+	uint8_t LCDSendText(const uint8_t *text, size_t length);
+	uint8_t LCDCharsetCode(uint32_t codePoint);
+	void LCDMarqueeLoad(uint32_t end);
+	uint8_t LCDPageAddress(uint8_t address);
+	void LCDFlushCostModelPlan(void);
 	
 	// Private Enums
-	/*!  DDRAM address's used to set cursor position  Note Private */
-	enum LCDAddress_e : uint8_t {
-		LCDLineAddressOne =  0x80,  /**< Line 1 */
-		LCDLineAddressTwo =  0xC0, /**< Line 2 */
-		LCDLineAddress3Col20 = 0x94, /**< Line 3 20x04 line 3 */
-		LCDLineAddress4Col20 = 0xD4, /**< Line 4 20x04 line 4 */
-		LCDLineAddress3Col16  = 0x90, /**< Line 3 16x04  untested, no part */
-		LCDLineAddress4Col16  = 0xD0 /**< Line 4 16x04 untested, no part */
-	}; 
-
 	/*!  Command Bytes General  Note Private */
 	enum LCDCmdBytesGeneral_e : uint8_t {
 		LCDCmdModeFourBit = 0x28, /**< Function set (4-bit interface, 2 lines, 5*7 Pixels) */
 		LCDCmdHomePosition  = 0x02, /**< Home (move cursor to top/left character position) */
 		LCDCmdDisplayOn = 0x0C,  /**< Restore the display (with cursor hidden) */
 		LCDCmdDisplayOff = 0x08, /**< Blank the display (without clearing) */
-		LCDCmdClearScreen = 0x01 /**< clear screen command byte*/
+		LCDCmdClearScreen = 0x01, /**< clear screen command byte*/
+		LCDCmdScrollLeft = 0x18, /**< Scroll display one character left (all lines) */
+		LCDCmdScrollRight = 0x1E /**< Scroll display one character right (all lines) */
 	};
+
+	static const uint16_t LCD_BATCH_MAX = 80; /**< Max bytes(data or command) coalesced into one I2C transaction, 4 frames each */
+	char _BatchBufferI2C[LCD_BATCH_MAX * 4]; /**< Batch buffer of PCF8574 nibble/enable frames */
+	uint16_t _BatchLen = 0; /**< Number of frame bytes currently held in _BatchBufferI2C */
+	uint8_t _BatchError = 0; /**< Status of batches sent because the buffer was full, returned by the next LCDBatchSend */
+	uint8_t _BatchStartCmd = 0; /**< Set address command for where the batch started, sent ahead of a retransmit, 0 = not known */
+
+	/*! HD44780 datasheet execution times, fosc = 270kHz */
+	enum LCDExecTime_e : uint16_t {
+		LCDExecTimeUs = 37, /**< Most instructions */
+		LCDExecTimeLongUs = 1520, /**< Clear display and return home */
+		LCDExecTimeInitUs = 4100, /**< First function set of initialization by instruction */
+		LCDExecTimeResyncUs = 100 /**< Second and third function set of initialization by instruction */
+	};
+	static const uint8_t LCD_BUSY_POLL_MAX = 100; /**< Busy flag reads before giving up, several mS on any bus speed */
+	enum LCDWaitMode_e _WaitMode = LCDWaitFixed; /**< How slow commands are waited for */
+	uint32_t _WaitOwedUs = 0; /**< LCDWaitDeferred, execution time of the last command not yet waited for */
+	std::chrono::steady_clock::time_point _WaitOwedSince; /**< LCDWaitDeferred, time the owed wait began */
+	HD44780LCDStats _Stats; /**< Driver counters*/
+	bool _StatsLatencyON = false; /**< Time each transfer into _Stats latency histogram*/
+	enum LCDRetryPolicy_e _RetryPolicy = LCDRetryFixed; /**< Delay between retry attempts*/
+	uint16_t _RetryBaseMs = 1; /**< Backoff, delay before the second retry, doubled after*/
+	uint16_t _RetryMaxMs = 50; /**< Backoff, delay cap*/
+	uint32_t _RetryJitter = 0x2545F491; /**< Backoff, xorshift state for jitter*/
+	uint8_t _BreakerThreshold = 0; /**< Consecutive failed transfers that open the breaker, 0 = breaker off*/
+	uint8_t _BreakerFailures = 0; /**< Consecutive failed transfers*/
+	bool _BreakerOpen = false; /**< Breaker open, transfers are rejected until a probe succeeds*/
+	uint32_t _BreakerProbeMs = 1000; /**< Time between LCDCheckConnection probes while open*/
+	std::chrono::steady_clock::time_point _BreakerProbeTime; /**< Next probe due*/
 	
 	enum  LCDBackLight_e _LCDBackLight= LCDBackLightOnMask;  /**< Enum to store backlight status*/
 	
 	
-	const int16_t _LibVersionNum = 133; /**< library version number */
+	const int16_t _LibVersionNum = 140; /**< library version number */
 	bool _DebugON = false;  /**< debug flag , if true error messages will be printed to console */
 	
 	const uint8_t LCD_I2C_ADDRESS = 0x27;  /**< Default I2C address for I2C module PCF8574 backpack on LCD */
@@ -129,10 +339,132 @@ class HD44780PCF8574LCD : public Print{
 	uint16_t _I2C_ErrorDelay = 100; /**<I2C delay(in between retry attempts) in event of error in mS*/
 	uint8_t _I2C_ErrorRetryNum = 3; /**< In event of I2C error number of retry attempts*/
 	uint8_t _I2C_ErrorFlag = 0; /**< In event of I2C error holds bcm2835 I2C reason code 0x00 = success*/
+	HD44780TransportBCM2835 _TransportBCM; /**< Default bus transport, bcm2835 library*/
+	HD44780TransportI2CDev _TransportI2CDev; /**< Linux i2c-dev bus transport*/
+	HD44780Transport *_Transport = &_TransportBCM; /**< Bus transport in use*/
+	std::unique_ptr<HD44780TransportAsync> _TransportAsync; /**< Async mode worker, wraps transport, null when off*/
+	uint32_t _AsyncErrorsSeen = 0; /**< Async mode, worker failed writes already reported by LCDBatchSend*/
 	
 	uint8_t _NumRowsLCD = 2; /**< number of rows on LCD*/
 	uint8_t _NumColsLCD = 16; /**< number of columns on LCD*/
+	HD44780Geometry _Geometry = HD44780GeometryMake(2, 16); /**< DDRAM row address table for rows x cols*/
+
+	static const uint8_t LCD_DDRAM_SIZE = 80; /**< HD44780 display data RAM size, max rows x cols*/
+	bool _ShadowON = false; /**< Shadow mode flag, if true text is drawn into _ShadowBuffer and sent by flush()*/
+	bool _ShadowGlassValid = false; /**< False if _ShadowGlass does not match the display, next flush sends every cell*/
+	uint8_t _ShadowBuffer[LCD_DDRAM_SIZE]; /**< Shadow of the display contents, rows x cols, as drawn by the user*/
+	uint8_t _ShadowGlass[LCD_DDRAM_SIZE]; /**< Display contents as of the last flush*/
+	bool _CursorKnown = false; /**< True if _CursorAddress matches the HD44780 address counter*/
+	uint8_t _CursorAddress = 0; /**< Tracked HD44780 DDRAM address counter*/
+	uint8_t _CGRAMAddress = HD44780AddressNone; /**< Tracked CGRAM address counter after set CGRAM address, else HD44780AddressNone*/
+	bool _EntryIncrement = true; /**< Tracked entry mode, address counter increments after data*/
+	uint8_t _DisplayShift = 0; /**< Tracked display shift, left shifts 0-39, column c shows line offset c + shift*/
+	uint8_t _ShadowRow = 0; /**< Shadow cursor row 0-3*/
+	uint8_t _ShadowCol = 0; /**< Shadow cursor column*/
+	enum LCDFlushPlan_e _FlushPlan = LCDFlushCostModel; /**< How flush() addresses the changed cells*/
+	bool _ShadowCursorON = false; /**< flush() leaves the HD44780 cursor at the shadow cursor*/
+	static const uint8_t LCD_DDRAM_LINE = 40; /**< DDRAM of each line in 2 line mode, 0x00-0x27 and 0x40-0x67*/
+	static const uint8_t LCD_FLUSH_COST_ADDRESS = 4; /**< Flush cost model, bus bytes of a set address command*/
+	static const uint8_t LCD_FLUSH_COST_CELL = 4; /**< Flush cost model, bus bytes of re-sending one unchanged cell*/
+
+	static const uint8_t LCD_GLYPH_MAX = 32; /**< Max glyphs in the registry*/
+	static const uint8_t LCD_CGRAM_SLOTS = 8; /**< HD44780 CGRAM character slots*/
+	static const uint16_t LCD_GLYPH_NONE = 0xFFFF; /**< Glyph ID of an unused registry entry or CGRAM slot*/
+	static const uint16_t LCD_GLYPH_PINNED = 0xFFFE; /**< Owner of a CGRAM slot reserved by LCDCreateCustomChar*/
+	uint16_t _GlyphID[LCD_GLYPH_MAX]; /**< Registry, glyph IDs*/
+	uint8_t _GlyphBitmap[LCD_GLYPH_MAX][8]; /**< Registry, glyph bitmaps 5x8*/
+	uint8_t _GlyphCount = 0; /**< Number of glyphs in the registry*/
+	uint16_t _GlyphSlotOwner[LCD_CGRAM_SLOTS] = {LCD_GLYPH_NONE, LCD_GLYPH_NONE, LCD_GLYPH_NONE, LCD_GLYPH_NONE,
+		LCD_GLYPH_NONE, LCD_GLYPH_NONE, LCD_GLYPH_NONE, LCD_GLYPH_NONE}; /**< Glyph ID resident in each CGRAM slot*/
+	uint32_t _GlyphSlotUsed[LCD_CGRAM_SLOTS] = {0}; /**< Tick of last use of each CGRAM slot, for LRU*/
+	uint32_t _GlyphTick = 0; /**< Glyph use counter*/
+	uint32_t _GlyphHits = 0; /**< Glyph loads that found the glyph resident*/
+	uint32_t _GlyphMisses = 0; /**< Glyph loads that uploaded to CGRAM*/
+
+	enum LCDCharset_e _Charset = LCDCharsetRaw; /**< Text to character code mapping*/
+	uint8_t _CharsetReplacement = '?'; /**< Character code for text with no ROM or glyph match*/
+	HD44780UTF8Decoder _UTF8Decoder; /**< UTF-8 state, carried between writes*/
+
+	bool _MarqueeON = false; /**< Marquee running, advanced by LCDMarqueeTick*/
+	std::string _MarqueeText; /**< Marquee message*/
+	uint8_t _MarqueeRowAddress = 0; /**< DDRAM address of column 0 of the marquee row*/
+	uint32_t _MarqueePeriod = 0; /**< Marquee loop length, message + gap, LCD_DDRAM_LINE if it fits in DDRAM*/
+	uint32_t _MarqueeStep = 0; /**< Display shifts done, loop position at column 0*/
+	uint32_t _MarqueeLoaded = 0; /**< Loop positions written to DDRAM so far*/
+	uint16_t _MarqueeStepMs = 300; /**< Time between shifts*/
+	std::chrono::steady_clock::time_point _MarqueeNext; /**< Next shift due*/
+	uint8_t _DisplayControl = LCDCmdDisplayOn; /**< Tracked display control command, display, cursor and blink bits*/
+	uint8_t _EntryMode = LCDEntryModeThree; /**< Tracked entry mode command*/
+	uint8_t _CGRAMMirror[LCD_CGRAM_SLOTS * 8] = {0}; /**< Last bitmap written to each CGRAM slot, for LCDSnapshotSave*/
+	uint8_t _CGRAMKnown = 0; /**< Bit per CGRAM slot, set if _CGRAMMirror holds what the slot contains*/
+	static const uint8_t LCD_SNAPSHOT_VERSION = 1; /**< LCDSnapshotSave file version*/
+	uint32_t _HealthIntervalMs = 0; /**< Time between health checks, 0 = off*/
+	bool _HealthSuspect = false; /**< A transfer failed or a recovery did not read back since the last check, check on the next tick*/
+	bool _HealthStatusRead = true; /**< Address counter read back, cleared once it reads 0xFF(RW not wired)*/
+	std::chrono::steady_clock::time_point _HealthNext; /**< Next health check due*/
+	uint8_t _PageOffset = 0; /**< DDRAM column of the page drawn on, 0 or LCD_DDRAM_LINE - columns*/
+	bool _PageComposing = false; /**< Drawing on the hidden page, between LCDPageBegin and LCDPageShow*/
 
 		
   }; // end of HD44780PCF8574LCD class
 
+/*!
+	@brief HD44780PCF8574LCD with the display size fixed at compile time
+	@details Row addresses and bounds come from a constexpr HD44780Geometry,
+		LCDGOTO is a table load with no switch on the size. Unsupported sizes fail to compile,
+		use HD44780PCF8574LCD for those.
+	@tparam Rows number of rows
+	@tparam Cols number of columns
+*/
+template <uint8_t Rows, uint8_t Cols>
+class HD44780LCD : public HD44780PCF8574LCD {
+  public:
+	static constexpr HD44780Geometry Geometry = HD44780GeometryMake(Rows, Cols); /**< Row address table */
+	static_assert(Geometry.Supported, "HD44780LCD size must be 8x1 16x1 16x2 16x4 20x2 20x4 24x2 or 40x2");
+
+	/*!
+		@brief Constructor, see HD44780PCF8574LCD
+		@param I2Caddress The PCF8574 I2C address
+		@param I2Cspeed I2C Bus Clock speed
+	*/
+	HD44780LCD(uint8_t I2Caddress, uint16_t I2Cspeed)
+		: HD44780PCF8574LCD(Rows, Cols, I2Caddress, I2Cspeed) {}
+	/*!
+		@brief Constructor with a user supplied bus transport, see HD44780PCF8574LCD
+		@param I2Caddress The PCF8574 I2C address
+		@param I2Cspeed I2C Bus Clock speed
+		@param transport bus transport, must outlive the LCD object
+	*/
+	HD44780LCD(uint8_t I2Caddress, uint16_t I2Cspeed, HD44780Transport &transport)
+		: HD44780PCF8574LCD(Rows, Cols, I2Caddress, I2Cspeed, transport) {}
+	/*!
+		@brief Constructor selecting the I2C interface, see HD44780PCF8574LCD
+		@param I2Caddress The PCF8574 I2C address
+		@param I2Cspeed I2C Bus Clock speed
+		@param busType LCDBusBCM2835 or LCDBusI2CDev
+		@param busNumber LCDBusI2CDev only, N in /dev/i2c-N
+	*/
+	HD44780LCD(uint8_t I2Caddress, uint16_t I2Cspeed, LCDBusType_e busType, uint8_t busNumber = 1)
+		: HD44780PCF8574LCD(Rows, Cols, I2Caddress, I2Cspeed, busType, busNumber) {}
+
+	/*!
+		@brief DDRAM address of a cell, compile time when the arguments are
+		@param row row 0 to Rows-1
+		@param col column 0 to Cols-1
+		@return DDRAM address
+	*/
+	static constexpr uint8_t CellAddress(uint8_t row, uint8_t col) { return HD44780CellAddress(Geometry, row, col);}
+
+	/*!
+		@brief moves cursor to an x , y position on display, table lookup
+		@param line row 1 to Rows
+		@param col column 0 to Cols-1
+		@return LCDStatus_e
+	*/
+	uint8_t LCDGOTO(LCDLineNumber_e line, uint8_t col)
+	{
+		uint8_t row = line - 1;
+		return LCDGOTOAddress(row, col, (row < Rows) ? CellAddress(row, col) : HD44780AddressNone);
+	}
+}; // end of HD44780LCD class
+
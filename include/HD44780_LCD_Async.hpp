@@ -0,0 +1,115 @@
+/*!
+	@file     HD44780_LCD_Async.hpp
+	@author   Gavin Lyons
+	@brief    Asynchronous bus transport for HD44780_LCD library. Writes and delays are
+		posted into a bounded single producer / single consumer ring buffer and
+		sent to the bus by a worker thread.
+	@details  URL: https://github.com/gavinlyonsrepo/HD44780_LCD_RPI
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "HD44780_LCD_Transport.hpp"
+
+// Section: Class's
+
+/*!
+	@brief Transport decorator that moves bus work onto a worker thread
+	@details One thread (the LCD API caller) may post, the worker thread drains
+		the ring into the inner transport, retrying failed writes.
+		Posting only blocks when the ring is full. Reads wait for the ring to drain.
+		After AsyncBreakerSet consecutive failed writes the worker drops writes unsent,
+		no retries or delays, until AsyncBreakerReset.
+*/
+class HD44780TransportAsync : public HD44780Transport {
+  public:
+	HD44780TransportAsync(HD44780Transport &inner, uint16_t ringSize = 256);
+	~HD44780TransportAsync();
+
+	bool I2CBegin(void) override;
+	void I2CEnd(void) override;
+	void I2CSpeedSet(uint16_t speed) override;
+	void I2CAddressSet(uint8_t address) override;
+	uint8_t I2CWrite(const char *buffer, uint32_t length) override;
+	uint8_t I2CRead(char *buffer, uint32_t length) override;
+	void DelayMs(uint32_t ms) override;
+	void DelayUs(uint32_t us) override;
+
+	void AsyncWait(void);
+	void AsyncRetrySet(uint8_t retryNum, uint16_t retryDelay, bool backoff = false, uint16_t backoffMaxMs = 50);
+	void AsyncRetryPrefixSet(const char *frames, uint8_t length);
+	void AsyncBreakerSet(uint8_t threshold);
+	void AsyncBreakerReset(void);
+	uint32_t AsyncFailStreakGet(void);
+	HD44780Transport &AsyncInnerGet(void);
+	uint16_t AsyncDepthGet(void);
+	uint16_t AsyncHighWaterGet(void);
+	void AsyncHighWaterReset(void);
+	uint32_t AsyncErrorCountGet(void);
+	uint8_t AsyncErrorGet(void);
+
+  private:
+	/*! Operation type held in a ring slot */
+	enum AsyncOpType_e : uint8_t {
+		AsyncOpWrite = 0, /**< Bus write, Data holds the bytes */
+		AsyncOpDelayMs = 1, /**< Delay, Arg holds mS */
+		AsyncOpDelayUs = 2 /**< Delay, Arg holds uS */
+	};
+
+	static const uint16_t ASYNC_SLOT_DATA = 64; /**< Write bytes per ring slot, 16 LCD bytes*/
+	static const uint8_t ASYNC_PREFIX_MAX = 4; /**< Retry prefix bytes, one LCD command*/
+	static const uint32_t ASYNC_RING_MAX = 32768; /**< Max ring slots, full depth fits the uint16_t getters*/
+
+	/*! One ring slot */
+	struct AsyncOp {
+		uint8_t Type; /**< AsyncOpType_e */
+		uint8_t Address; /**< I2C address for writes */
+		bool More; /**< Write continues in next slot, same I2C transaction */
+		uint8_t PrefixLength; /**< Bytes used in Prefix, first slot of a write only */
+		uint16_t Length; /**< Bytes used in Data */
+		uint32_t Arg; /**< Delay time */
+		char Prefix[ASYNC_PREFIX_MAX]; /**< Sent ahead of the write when it is retried */
+		char Data[ASYNC_SLOT_DATA]; /**< Write bytes */
+	};
+
+	AsyncOp &AsyncReserve(void);
+	void AsyncCommit(void);
+	void AsyncWorker(void);
+	void AsyncExecute(const AsyncOp &op);
+
+	HD44780Transport &_Inner; /**< Transport the worker sends to*/
+	uint32_t _RingMask; /**< Ring size - 1, ring size is a power of two*/
+	std::unique_ptr<AsyncOp[]> _Ring; /**< Ring slots*/
+	std::atomic<uint32_t> _Head{0}; /**< Next slot to drain, written by worker only*/
+	std::atomic<uint32_t> _Tail{0}; /**< Next slot to fill, written by producer only*/
+	std::atomic<uint16_t> _HighWater{0}; /**< Max ring depth seen at a post*/
+	uint8_t _Address = 0x27; /**< I2C address for following writes*/
+	char _PrefixNext[ASYNC_PREFIX_MAX]; /**< Retry prefix for the next write posted*/
+	uint8_t _PrefixNextLength = 0; /**< Bytes in _PrefixNext, 0 = none*/
+
+	std::atomic<uint8_t> _RetryNum{3}; /**< Worker retry attempts on a failed write*/
+	std::atomic<uint16_t> _RetryDelay{100}; /**< Worker delay between retry attempts mS, backoff base delay*/
+	std::atomic<bool> _RetryBackoff{false}; /**< Worker retry delays, false = fixed, true = HD44780RetryBackoffMs*/
+	std::atomic<uint16_t> _RetryMaxMs{50}; /**< Worker backoff delay cap mS*/
+	uint32_t _RetryJitter = 0x2545F491; /**< Worker backoff xorshift state, worker only*/
+	std::atomic<uint8_t> _BreakerThreshold{0}; /**< Consecutive failed writes before writes are dropped, 0 = never*/
+	std::atomic<uint32_t> _FailStreak{0}; /**< Consecutive writes failed after all retries or dropped*/
+	std::atomic<uint32_t> _ErrorCount{0}; /**< Writes that failed after all retries*/
+	std::atomic<uint8_t> _LastError{0}; /**< bcm2835I2CReasonCodes of last failed write*/
+
+	std::vector<char> _WorkerBuffer; /**< Worker joins slots of one write here*/
+	char _WorkerPrefix[ASYNC_PREFIX_MAX]; /**< Retry prefix of the write being joined*/
+	uint8_t _WorkerPrefixLength = 0; /**< Bytes in _WorkerPrefix*/
+	std::atomic<bool> _Stop{false}; /**< Worker exits once ring is drained*/
+	std::atomic<bool> _Sleeping{false}; /**< Worker is waiting for work*/
+	std::atomic<bool> _Busy{false}; /**< Worker is executing a slot*/
+	std::mutex _WakeMutex; /**< Only used to sleep and wake the worker*/
+	std::condition_variable _WakeCondition; /**< Only used to sleep and wake the worker*/
+	std::thread _Worker; /**< Worker thread*/
+}; // end of HD44780TransportAsync class
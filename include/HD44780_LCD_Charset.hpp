@@ -0,0 +1,136 @@
+/*!
+	@file     HD44780_LCD_Charset.hpp
+	@author   Gavin Lyons
+	@brief    UTF-8 decoder and character ROM tables for HD44780_LCD library.
+		Maps Unicode code points to the HD44780 A00 (Japanese) or A02 (European) character ROM.
+	@details  URL: https://github.com/gavinlyonsrepo/HD44780_LCD_RPI
+*/
+
+#pragma once
+
+#include <cstdint>
+
+/*! Code point emitted for a malformed UTF-8 sequence */
+static const uint32_t HD44780CodePointInvalid = 0xFFFD;
+
+/*!
+	@brief Streaming UTF-8 decoder, one byte at a time, no allocation
+	@details State is kept between calls so a sequence may be split across writes,
+		e.g. print(char) one byte at a time. Malformed input, overlong forms and
+		surrogates decode as HD44780CodePointInvalid.
+*/
+struct HD44780UTF8Decoder {
+	uint32_t CodePoint = 0; /**< Code point being assembled */
+	uint32_t Minimum = 0; /**< Smallest code point valid for the sequence length, rejects overlong forms */
+	uint8_t Remaining = 0; /**< Continuation bytes still expected */
+
+	/*!
+		@brief Feed one byte
+		@param byte next byte of the text
+		@param codePoint set when a code point is complete
+		@param consumed set false if byte broke a sequence and must be fed again
+		@return true if codePoint is complete
+	*/
+	bool Step(uint8_t byte, uint32_t &codePoint, bool &consumed)
+	{
+		consumed = true;
+		if (Remaining > 0)
+		{
+			if ((byte & 0xC0) != 0x80) // sequence cut short
+			{
+				Remaining = 0;
+				consumed = false;
+				codePoint = HD44780CodePointInvalid;
+				return true;
+			}
+			CodePoint = (CodePoint << 6) | (byte & 0x3F);
+			if (--Remaining > 0) return false;
+			bool valid = CodePoint >= Minimum && CodePoint <= 0x10FFFF && (CodePoint & 0xFFF800) != 0xD800;
+			codePoint = valid ? CodePoint : HD44780CodePointInvalid;
+			return true;
+		}
+		if (byte < 0x80) { codePoint = byte; return true; }
+		if ((byte & 0xE0) == 0xC0) { CodePoint = byte & 0x1F; Minimum = 0x80; Remaining = 1; return false; }
+		if ((byte & 0xF0) == 0xE0) { CodePoint = byte & 0x0F; Minimum = 0x800; Remaining = 2; return false; }
+		if ((byte & 0xF8) == 0xF0) { CodePoint = byte & 0x07; Minimum = 0x10000; Remaining = 3; return false; }
+		codePoint = HD44780CodePointInvalid; // stray continuation or 0xF8-0xFF
+		return true;
+	}
+
+	/*! @brief Drop a partly decoded sequence */
+	void Reset(void) { Remaining = 0;}
+};
+
+/*!
+	@brief One code point to ROM code entry, tables sorted by code point
+*/
+struct HD44780CharsetEntry {
+	uint16_t CodePoint; /**< Unicode code point */
+	uint8_t Code; /**< HD44780 character code */
+};
+
+/*! A00 ROM codes for U+00A0-U+00FF, 0 = not in ROM */
+static constexpr uint8_t HD44780CharsetA00Latin1[96] = {
+	0x20, 0x00, 0xEC, 0xED, 0x00, 0x5C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // nbsp ¢ £ ¥
+	0xDF, 0x00, 0x00, 0x00, 0x00, 0xE4, 0x00, 0xA5, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // ° µ ·
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE2, // ß
+	0x00, 0x00, 0x00, 0x00, 0xE1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // ä
+	0x00, 0xEE, 0x00, 0x00, 0x00, 0x00, 0xEF, 0xFD, 0x00, 0x00, 0x00, 0x00, 0xF5, 0x00, 0x00, 0x00  // ñ ö ÷ ü
+};
+
+/*! A00 ROM codes outside ASCII and U+00A0-U+00FF, half width katakana excluded */
+static constexpr HD44780CharsetEntry HD44780CharsetA00[] = {
+	{0x03A3, 0xF6}, {0x03A9, 0xF4}, {0x03B1, 0xE0}, {0x03B2, 0xE2}, {0x03B5, 0xE3}, // Σ Ω α β ε
+	{0x03B8, 0xF2}, {0x03BC, 0xE4}, {0x03C0, 0xF7}, {0x03C1, 0xE6}, {0x03C3, 0xE5}, // θ μ π ρ σ
+	{0x2190, 0x7F}, {0x2192, 0x7E}, {0x221A, 0xE8}, {0x221E, 0xF3}, {0x2588, 0xFF}, // ← → √ ∞ █
+	{0x3001, 0xA4}, {0x3002, 0xA1}, {0x300C, 0xA2}, {0x300D, 0xA3}, {0x30FB, 0xA5}, // 、 。 「 」 ・
+	{0x4E07, 0xFB}, {0x5186, 0xFC}, {0x5343, 0xFA} // 万 円 千
+};
+
+/*!
+	@brief Look up the ROM code of a code point
+	@param romA02 true for the A02 ROM, false for A00
+	@param codePoint Unicode code point
+	@param code set to the character code if found
+	@return false if the ROM has no such character
+	@details ASCII and the U+00A0-U+00FF block are direct table loads, the rest is a
+		binary search of a short sorted table, or a range for half width katakana.
+		A02 follows ISO 8859-1 from 0xA0 to 0xFF. A00 has ¥ and → ← where ASCII
+		has \ and ~, so those two have no A00 code.
+*/
+inline bool HD44780CharsetLookup(bool romA02, uint32_t codePoint, uint8_t &code)
+{
+	if (codePoint < 0x7F) // below 0x20 passed through, 0x00-0x07 print CGRAM
+	{
+		if (romA02 == false && (codePoint == '\\' || codePoint == '~')) return false;
+		code = codePoint;
+		return true;
+	}
+	if (codePoint >= 0xA0 && codePoint <= 0xFF)
+	{
+		code = romA02 ? codePoint : HD44780CharsetA00Latin1[codePoint - 0xA0];
+		return code != 0;
+	}
+	if (romA02 == true) return false;
+	if (codePoint >= 0xFF61 && codePoint <= 0xFF9F) // half width katakana and marks
+	{
+		code = 0xA1 + (codePoint - 0xFF61);
+		return true;
+	}
+
+	uint8_t low = 0;
+	uint8_t high = sizeof(HD44780CharsetA00) / sizeof(HD44780CharsetA00[0]);
+	while (low < high)
+	{
+		uint8_t mid = (low + high) / 2;
+		if (HD44780CharsetA00[mid].CodePoint < codePoint) low = mid + 1;
+		else high = mid;
+	}
+	if (low < sizeof(HD44780CharsetA00) / sizeof(HD44780CharsetA00[0]) && HD44780CharsetA00[low].CodePoint == codePoint)
+	{
+		code = HD44780CharsetA00[low].Code;
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,285 @@
+/*!
+	@file     HD44780_LCD_Coro.hpp
+	@author   Gavin Lyons
+	@brief    C++20 coroutine animations for HD44780_LCD library. Sequences such as blink,
+		scroll or countdown are written as coroutines that await timers and display
+		operations, a single threaded scheduler interleaves any number of them.
+	@details  URL: https://github.com/gavinlyonsrepo/HD44780_LCD_RPI
+	@note Header only, needs -std=c++2a (g++ 10 also -fcoroutines), the library itself is not.
+		Put the displays in LCDWaitDeferred mode so slow commands are waited out by the
+		scheduler running other tasks rather than by a delay.
+*/
+
+#pragma once
+
+#if !defined(__cpp_impl_coroutine) && !defined(__cpp_coroutines)
+#error "HD44780_LCD_Coro.hpp needs coroutines, compile with -std=c++2a -fcoroutines"
+#endif
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "HD44780_LCD.hpp"
+
+// Section: Class's
+
+/*!
+	@brief Coroutine handle returned by an animation, e.g. HD44780LCDTask Blink(...)
+	@details Starts suspended. Pass it to HD44780LCDScheduler::SchedulerSpawn to run it
+		alongside the others, or co_await it from another task to run it as one step of a
+		longer sequence. Move only, the coroutine frame is freed with the task.
+*/
+class HD44780LCDTask {
+  public:
+	/*! Coroutine promise, used by the compiler */
+	struct promise_type {
+		std::coroutine_handle<> Continuation; /**< Task awaiting this one, resumed when it ends */
+
+		/*! Resumes the awaiting task, if any, when the coroutine ends */
+		struct FinalAwaiter {
+			bool await_ready() noexcept { return false;}
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+			{
+				std::coroutine_handle<> next = handle.promise().Continuation;
+				return next ? next : std::noop_coroutine();
+			}
+			void await_resume() noexcept {}
+		};
+
+		HD44780LCDTask get_return_object() { return HD44780LCDTask(std::coroutine_handle<promise_type>::from_promise(*this));}
+		std::suspend_always initial_suspend() noexcept { return {};}
+		FinalAwaiter final_suspend() noexcept { return {};}
+		void return_void() {}
+		void unhandled_exception() { std::terminate();}
+	};
+
+	HD44780LCDTask(HD44780LCDTask &&other) noexcept : _Handle(std::exchange(other._Handle, nullptr)) {}
+	HD44780LCDTask &operator=(HD44780LCDTask &&other) noexcept
+	{
+		if (this != &other)
+		{
+			if (_Handle) _Handle.destroy();
+			_Handle = std::exchange(other._Handle, nullptr);
+		}
+		return *this;
+	}
+	HD44780LCDTask(const HD44780LCDTask &) = delete;
+	HD44780LCDTask &operator=(const HD44780LCDTask &) = delete;
+	~HD44780LCDTask() { if (_Handle) _Handle.destroy();}
+
+	/*! @brief Check if the coroutine has run to the end @return true if finished */
+	bool TaskDoneGet(void) const { return !_Handle || _Handle.done();}
+	/*! @brief Coroutine handle, for the scheduler @return handle */
+	std::coroutine_handle<> TaskHandleGet(void) const { return _Handle;}
+
+	// co_await on a task runs it to the end as a sub sequence of the awaiting task
+	bool await_ready() const noexcept { return TaskDoneGet();}
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+	{
+		_Handle.promise().Continuation = awaiting;
+		return _Handle;
+	}
+	void await_resume() noexcept {}
+
+  private:
+	explicit HD44780LCDTask(std::coroutine_handle<promise_type> handle) : _Handle(handle) {}
+
+	std::coroutine_handle<promise_type> _Handle; /**< Coroutine frame, owned */
+}; // end of HD44780LCDTask class
+
+/*!
+	@brief Single threaded scheduler for HD44780LCDTask coroutines
+	@details Ready tasks run in FIFO order. Sleeping tasks wait in a binary heap keyed on
+		wake time, equal times wake in the order they went to sleep. Nothing here blocks
+		except SchedulerRun when no task is ready. Use all of it from one thread.
+		In virtual time mode the clock jumps to the next wake time instead of sleeping,
+		for running animations against HD44780TransportSim faster than real time.
+*/
+class HD44780LCDScheduler {
+  public:
+	/*! Awaitable, suspends the task until a wake time */
+	struct SleepAwaiter {
+		HD44780LCDScheduler *Scheduler; /**< Owning scheduler */
+		uint64_t DelayUs; /**< Time to sleep */
+		bool await_ready() const noexcept { return false;}
+		void await_suspend(std::coroutine_handle<> handle) { Scheduler->SchedulerWake(handle, DelayUs);}
+		void await_resume() const noexcept {}
+	};
+
+	/*!
+		@brief Awaitable, runs a display operation once the display is ready
+		@details If the display still owes time for a slow command (LCDWaitOwedUsGet) the
+			task sleeps that long first, other tasks run meanwhile. The result of the
+			operation, usually LCDStatus_e, is the result of the co_await.
+	*/
+	template <typename Op>
+	struct OpAwaiter {
+		HD44780LCDScheduler *Scheduler; /**< Owning scheduler */
+		HD44780PCF8574LCD *Display; /**< Display the operation is for */
+		Op Operation; /**< Callable making the driver calls */
+		bool await_ready() { return Display->LCDWaitOwedUsGet() == 0;}
+		void await_suspend(std::coroutine_handle<> handle) { Scheduler->SchedulerWake(handle, Display->LCDWaitOwedUsGet());}
+		decltype(auto) await_resume() { return Operation();}
+	};
+
+	/*!
+		@brief Constructor
+		@param virtualTime true = clock advanced by the scheduler, never sleeps, for simulation
+	*/
+	explicit HD44780LCDScheduler(bool virtualTime = false) : _VirtualTime(virtualTime),
+		_Start(std::chrono::steady_clock::now()) {}
+
+	/*!
+		@brief Take ownership of a task and queue it to run
+		@param task coroutine, e.g. SchedulerSpawn(Blink(myLCD, ...))
+	*/
+	void SchedulerSpawn(HD44780LCDTask task)
+	{
+		if (task.TaskDoneGet() == true) return;
+		_Ready.push_back(task.TaskHandleGet());
+		_Tasks.push_back(std::move(task));
+	}
+
+	/*!
+		@brief Awaitable timer, co_await myScheduler.SchedulerSleepMs(250);
+		@param ms delay
+		@return awaitable
+	*/
+	SleepAwaiter SchedulerSleepMs(uint32_t ms) { return SleepAwaiter{this, static_cast<uint64_t>(ms) * 1000};}
+
+	/*!
+		@brief Awaitable timer in uS
+		@param us delay
+		@return awaitable
+	*/
+	SleepAwaiter SchedulerSleepUs(uint32_t us) { return SleepAwaiter{this, us};}
+
+	/*!
+		@brief Awaitable, lets every other ready task run once
+		@return awaitable
+	*/
+	SleepAwaiter SchedulerYield(void) { return SleepAwaiter{this, 0};}
+
+	/*!
+		@brief Awaitable display operation
+		@param display display the operation uses
+		@param op callable, e.g. [&]{ return myLCD.LCDClearScreenCmd(); }
+		@return awaitable, co_await gives the result of op
+		@details op runs in one go, so operations of different tasks never interleave
+			within one another, only between. Two tasks may wait for the same display
+			to be ready, the second then waits out the first one's command in the driver.
+	*/
+	template <typename Op>
+	OpAwaiter<Op> SchedulerOp(HD44780PCF8574LCD &display, Op op) { return OpAwaiter<Op>{this, &display, std::move(op)};}
+
+	/*!
+		@brief Run the tasks that are ready or whose wake time has passed, returns without waiting
+		@return true if any task is unfinished
+		@details Tasks made ready while polling (a yield) run on the next poll, so a busy
+			task can not starve the rest.
+	*/
+	bool SchedulerPoll(void)
+	{
+		uint64_t now = SchedulerNowUs();
+		while (_Timers.empty() == false && _Timers.top().WakeUs <= now)
+		{
+			_Ready.push_back(_Timers.top().Handle);
+			_Timers.pop();
+		}
+		for (size_t count = _Ready.size(); count > 0; count--)
+		{
+			std::coroutine_handle<> handle = _Ready.front();
+			_Ready.pop_front();
+			handle.resume();
+		}
+		for (size_t index = 0; index < _Tasks.size(); )
+		{
+			if (_Tasks[index].TaskDoneGet() == true)
+			{
+				_Tasks[index] = std::move(_Tasks.back());
+				_Tasks.pop_back();
+			}
+			else index++;
+		}
+		return _Tasks.empty() == false;
+	}
+
+	/*!
+		@brief Run until every task has finished, sleeping (or in virtual time jumping)
+			to the next wake time when nothing is ready
+	*/
+	void SchedulerRun(void)
+	{
+		while (SchedulerPoll() == true)
+		{
+			if (_Ready.empty() == false) continue;
+			if (_Timers.empty() == true) break; // every task awaits something outside the scheduler
+			uint64_t wake = _Timers.top().WakeUs;
+			if (_VirtualTime == true)
+			{
+				if (wake > _VirtualUs) _VirtualUs = wake;
+			}
+			else
+			{
+				std::this_thread::sleep_until(_Start + std::chrono::microseconds(wake));
+			}
+		}
+	}
+
+	/*!
+		@brief Get the scheduler clock
+		@return uS since construction, real or virtual
+	*/
+	uint64_t SchedulerNowUs(void)
+	{
+		if (_VirtualTime == true) return _VirtualUs;
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _Start).count();
+	}
+
+	/*!
+		@brief Get the number of unfinished spawned tasks
+		@return task count
+	*/
+	size_t SchedulerTaskCountGet(void) { return _Tasks.size();}
+
+  private:
+	/*! Sleeping task, heap entry */
+	struct Timer {
+		uint64_t WakeUs; /**< Scheduler clock at which to wake */
+		uint64_t Sequence; /**< Order of going to sleep, breaks ties */
+		std::coroutine_handle<> Handle; /**< Task to resume */
+	};
+
+	/*! Heap order, earliest wake time on top */
+	struct TimerLater {
+		bool operator()(const Timer &a, const Timer &b) const
+		{
+			return (a.WakeUs != b.WakeUs) ? a.WakeUs > b.WakeUs : a.Sequence > b.Sequence;
+		}
+	};
+
+	/*!
+		@brief Queue a suspended task to be resumed after a delay
+		@param handle task
+		@param delayUs 0 = back of the ready queue
+	*/
+	void SchedulerWake(std::coroutine_handle<> handle, uint64_t delayUs)
+	{
+		if (delayUs == 0) _Ready.push_back(handle);
+		else _Timers.push(Timer{SchedulerNowUs() + delayUs, _Sequence++, handle});
+	}
+
+	bool _VirtualTime; /**< Clock advanced by SchedulerRun, not real time */
+	uint64_t _VirtualUs = 0; /**< Virtual clock uS */
+	uint64_t _Sequence = 0; /**< Next timer sequence number */
+	std::chrono::steady_clock::time_point _Start; /**< Real clock zero */
+	std::deque<std::coroutine_handle<>> _Ready; /**< Tasks to resume, FIFO */
+	std::priority_queue<Timer, std::vector<Timer>, TimerLater> _Timers; /**< Sleeping tasks */
+	std::vector<HD44780LCDTask> _Tasks; /**< Spawned tasks, owned */
+}; // end of HD44780LCDScheduler class
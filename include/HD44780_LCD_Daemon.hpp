@@ -0,0 +1,111 @@
+/*!
+	@file     HD44780_LCD_Daemon.hpp
+	@author   Gavin Lyons
+	@brief    Display daemon for HD44780_LCD library. One process owns the bus and the
+		displays, other processes draw into a shared memory framebuffer per display and
+		send commands over a Unix domain socket.
+	@details  URL: https://github.com/gavinlyonsrepo/HD44780_LCD_RPI
+	@note Per display "name" :
+		-# Framebuffer : POSIX shared memory /hd44780_name, a HD44780DaemonShm
+		-# Commands : stream socket /tmp/hd44780_name.sock, one text line each, reply "OK" or "ERR reason"
+		-# cursor row col | cursortype off|on|blink|onblink | backlight on|off |
+			glyph slot b0 .. b7 (hex) | rate hz | flush | quit
+*/
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include "HD44780_LCD.hpp"
+
+// Section: Structs
+
+/*!
+	@brief Layout of the shared memory framebuffer of one display
+	@details Clients write Cells with plain memory writes, rows x cols row major, character
+		codes as for LCDSendChar(0-7 = custom glyphs). The daemon copies and flushes the
+		cells at its rate. Writes landing during a copy show on the next flush.
+*/
+struct HD44780DaemonShm {
+	uint32_t Magic; /**< HD44780_DAEMON_MAGIC once the daemon has set up the buffer */
+	uint8_t Rows; /**< Rows of the display */
+	uint8_t Cols; /**< Columns of the display */
+	uint16_t RateHz; /**< Flush rate */
+	volatile uint32_t Flushes; /**< Incremented by the daemon after each flush */
+	uint8_t Cells[80]; /**< Display contents, Cells[row * Cols + col] */
+};
+
+static const uint32_t HD44780_DAEMON_MAGIC = 0x53344448; /**< "HD4S" */
+
+// Section: Class's
+
+/*!
+	@brief Serves shared memory framebuffers and command sockets for one or more displays
+	@details Single threaded, all bus access happens inside DaemonPoll. Each display must
+		be initialised before DaemonAdd, it is put in shadow mode so only changed cells
+		are sent.
+*/
+class HD44780LCDDaemon {
+  public:
+	HD44780LCDDaemon(uint16_t rateHz = 20);
+	~HD44780LCDDaemon();
+
+	bool DaemonAdd(HD44780PCF8574LCD &display, const std::string &name);
+	bool DaemonPoll(int timeoutMs);
+	void DaemonRun(void);
+	void DaemonStop(void);
+	uint16_t DaemonRateGet(void);
+	void DaemonRateSet(uint16_t rateHz);
+
+	static std::string DaemonShmName(const std::string &name);
+	static std::string DaemonSocketPath(const std::string &name);
+
+  private:
+	static const uint8_t DAEMON_MAX_PANELS = 8; /**< Max displays per daemon */
+	static const uint8_t DAEMON_MAX_CLIENTS = 8; /**< Max connected clients per display */
+	static const uint8_t DAEMON_LINE_MAX = 96; /**< Longest command line */
+
+	/*! One display served by the daemon */
+	struct DaemonPanel {
+		HD44780PCF8574LCD *Display = nullptr; /**< Display, owned by the caller */
+		std::string Name; /**< Name used for the shared memory and socket */
+		HD44780DaemonShm *Shm = nullptr; /**< Mapped framebuffer */
+		int ListenFd = -1; /**< Listening socket */
+		int Clients[DAEMON_MAX_CLIENTS]; /**< Connected client sockets, -1 = free */
+		char Input[DAEMON_MAX_CLIENTS][DAEMON_LINE_MAX]; /**< Partial command line of each client */
+		uint8_t InputLen[DAEMON_MAX_CLIENTS]; /**< Bytes in Input */
+		uint8_t CursorRow = 0; /**< Cursor row 0-3 left after each flush */
+		uint8_t CursorCol = 0; /**< Cursor column */
+		HD44780PCF8574LCD::LCDCursorType_e CursorType = HD44780PCF8574LCD::LCDCursorTypeOff; /**< Cursor type */
+	};
+
+	void DaemonFlush(DaemonPanel &panel);
+	void DaemonAccept(DaemonPanel &panel);
+	void DaemonRead(DaemonPanel &panel, uint8_t client);
+	std::string DaemonCommand(DaemonPanel &panel, const char *line);
+	void DaemonRemove(DaemonPanel &panel);
+
+	DaemonPanel _Panels[DAEMON_MAX_PANELS]; /**< Displays served */
+	uint8_t _NumPanels = 0; /**< Number of displays served */
+	uint16_t _RateHz = 20; /**< Flushes per second */
+	bool _Running = true; /**< Cleared by quit command or DaemonStop */
+	uint64_t _NextFlushUs = 0; /**< Monotonic time of the next flush */
+}; // end of HD44780LCDDaemon class
+
+/*!
+	@brief Client side of HD44780LCDDaemon, maps the framebuffer and sends commands
+*/
+class HD44780DaemonClient {
+  public:
+	~HD44780DaemonClient();
+
+	bool ClientOpen(const std::string &name);
+	void ClientClose(void);
+	HD44780DaemonShm *ClientShmGet(void);
+	void ClientPrint(uint8_t row, uint8_t col, const std::string &text);
+	std::string ClientCommand(const std::string &command);
+
+  private:
+	HD44780DaemonShm *_Shm = nullptr; /**< Mapped framebuffer */
+	int _Socket = -1; /**< Connected command socket */
+}; // end of HD44780DaemonClient class
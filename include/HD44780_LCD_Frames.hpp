@@ -0,0 +1,61 @@
+/*!
+	@file     HD44780_LCD_Frames.hpp
+	@author   Gavin Lyons
+	@brief    Compile time PCF8574 frame tables for HD44780_LCD library.
+		Every byte sent to the LCD is four PCF8574 frames, upper nibble with enable
+		high then low, lower nibble with enable high then low.
+	@details  URL: https://github.com/gavinlyonsrepo/HD44780_LCD_RPI
+*/
+
+#pragma once
+
+#include <cstdint>
+
+/*! PCF8574 mask nibbles, DATA-led-en-rw-rs (en=enable rs = reg select)(rw always write) */
+enum HD44780FrameMask_e : uint8_t {
+	HD44780DataByteOn = 0x0D, /**< enable=1 and rs =1 1101 */
+	HD44780DataByteOff = 0x09, /**< enable=0 and rs =1 1001 */
+	HD44780CmdByteOn = 0x0C, /**< enable=1 and rs =0 1100 */
+	HD44780CmdByteOff = 0x08, /**< enable=0 and rs =0 1000 */
+	HD44780BackLightBit = 0x08 /**< led bit, cleared when backlight off */
+};
+
+/*!
+	@brief The four PCF8574 frames for every byte value, for one RS + backlight combination
+*/
+struct HD44780FrameTable {
+	uint8_t Frames[256][4]; /**< Frames[byte] = the 4 bytes written to the PCF8574 */
+};
+
+/*!
+	@brief Build a frame table at compile time
+	@param maskOn PCF8574 mask with enable = 1
+	@param maskOff PCF8574 mask with enable = 0
+	@return table for all 256 byte values
+*/
+constexpr HD44780FrameTable HD44780FrameTableMake(uint8_t maskOn, uint8_t maskOff)
+{
+	HD44780FrameTable table{};
+	for (uint16_t value = 0; value < 256; value++)
+	{
+		uint8_t nibbleUpper = value & 0xF0;
+		uint8_t nibbleLower = (value << 4) & 0xF0;
+		table.Frames[value][0] = nibbleUpper | maskOn;
+		table.Frames[value][1] = nibbleUpper | maskOff;
+		table.Frames[value][2] = nibbleLower | maskOn;
+		table.Frames[value][3] = nibbleLower | maskOff;
+	}
+	return table;
+}
+
+/*! Frame tables indexed [rs][backlight], rs 0 = command 1 = data, backlight 0 = off 1 = on */
+inline constexpr HD44780FrameTable HD44780FrameTables[2][2] = {
+	{
+		HD44780FrameTableMake(HD44780CmdByteOn & ~HD44780BackLightBit, HD44780CmdByteOff & ~HD44780BackLightBit),
+		HD44780FrameTableMake(HD44780CmdByteOn, HD44780CmdByteOff)
+	},
+	{
+		HD44780FrameTableMake(HD44780DataByteOn & ~HD44780BackLightBit, HD44780DataByteOff & ~HD44780BackLightBit),
+		HD44780FrameTableMake(HD44780DataByteOn, HD44780DataByteOff)
+	}
+};
@@ -0,0 +1,62 @@
+/*!
+	@file     HD44780_LCD_Geometry.hpp
+	@author   Gavin Lyons
+	@brief    Compile time display geometry for HD44780_LCD library, DDRAM address of every row.
+		The driver always sets 2 line mode, DDRAM is then 0x00-0x27 and 0x40-0x67.
+		Rows 3 and 4 of a 4 line display continue rows 1 and 2 after NumCol characters.
+	@details  URL: https://github.com/gavinlyonsrepo/HD44780_LCD_RPI
+*/
+
+#pragma once
+
+#include <cstdint>
+
+/*! DDRAM address returned for a row the display does not have */
+static const uint8_t HD44780AddressNone = 0xFF;
+
+/*!
+	@brief Row addressing of one display size
+*/
+struct HD44780Geometry {
+	uint8_t Rows; /**< Number of rows */
+	uint8_t Cols; /**< Number of columns */
+	uint8_t RowAddress[4]; /**< DDRAM address of column 0 of each row, HD44780AddressNone if no such row */
+	uint8_t SplitColumn; /**< 16x1 only, first column of the right half which is at 0x40, 0 = not split */
+	bool Supported; /**< true for the sizes listed in HD44780GeometryMake */
+};
+
+/*!
+	@brief Build the row address table of a display size
+	@param rows number of rows
+	@param cols number of columns
+	@return geometry, Supported is set for 8x1, 16x1, 16x2, 16x4, 20x2, 20x4, 24x2 and 40x2
+	@note 16x1 panels are wired as 8x2, columns 8-15 are the second line at 0x40.
+*/
+constexpr HD44780Geometry HD44780GeometryMake(uint8_t rows, uint8_t cols)
+{
+	HD44780Geometry geometry{rows, cols, {HD44780AddressNone, HD44780AddressNone, HD44780AddressNone, HD44780AddressNone}, 0, false};
+	const uint8_t rowStart[4] = {0x00, 0x40, cols, static_cast<uint8_t>(0x40 + cols)};
+	for (uint8_t row = 0; row < rows && row < 4; row++)
+		geometry.RowAddress[row] = rowStart[row];
+	if (rows == 1 && cols == 16) geometry.SplitColumn = 8;
+
+	geometry.Supported =
+		(rows == 1 && (cols == 8 || cols == 16)) ||
+		(rows == 2 && (cols == 16 || cols == 20 || cols == 24 || cols == 40)) ||
+		(rows == 4 && (cols == 16 || cols == 20));
+	return geometry;
+}
+
+/*!
+	@brief DDRAM address of a cell
+	@param geometry display size
+	@param row row 0-3, must exist
+	@param col column 0 to Cols-1
+	@return DDRAM address, 0x00-0x67
+	@note With a constexpr geometry this is a table load and an add, the split test folds away.
+*/
+constexpr uint8_t HD44780CellAddress(const HD44780Geometry &geometry, uint8_t row, uint8_t col)
+{
+	return geometry.RowAddress[row] + col +
+		((geometry.SplitColumn != 0 && col >= geometry.SplitColumn) ? (0x40 - geometry.SplitColumn) : 0);
+}
@@ -0,0 +1,99 @@
+/*!
+	@file     HD44780_LCD_Group.hpp
+	@author   Gavin Lyons
+	@brief    Display group for HD44780_LCD library, many PCF8574 backpacks on one I2C bus.
+	@details  URL: https://github.com/gavinlyonsrepo/HD44780_LCD_RPI
+*/
+
+#pragma once
+
+#include <chrono>
+#include "HD44780_LCD.hpp"
+
+// Section: Structs
+
+/*!
+	@brief Counters for one display in a HD44780LCDGroup
+*/
+struct HD44780GroupDisplayStats {
+	uint8_t Address = 0; /**< I2C address of the display */
+	uint32_t Flushes = 0; /**< flush() calls made by the group */
+	uint32_t Transactions = 0; /**< I2C transactions to this display */
+	uint32_t BytesWritten = 0; /**< Bytes written to this display */
+	uint32_t LastLatencyUs = 0; /**< Time taken by the last flush uS */
+	uint32_t MaxLatencyUs = 0; /**< Longest flush uS */
+	uint64_t TotalLatencyUs = 0; /**< Sum of flush times uS, / Flushes for the mean */
+	uint32_t MaxLatenessUs = 0; /**< Deadline order, longest time a flush started after its deadline uS */
+};
+
+/*!
+	@brief Counters for the whole bus of a HD44780LCDGroup
+*/
+struct HD44780GroupStats {
+	uint32_t Transactions = 0; /**< I2C transactions on the bus */
+	uint32_t BytesWritten = 0; /**< Bytes written on the bus */
+	uint32_t AddressSwitches = 0; /**< Times the slave address actually changed */
+	uint64_t ElapsedUs = 0; /**< Time since construction or last reset uS */
+	double BytesPerSecond = 0; /**< BytesWritten / ElapsedUs, aggregate throughput */
+};
+
+// Section: Class's
+
+/*!
+	@brief Owns the I2C bus for up to GROUP_MAX_DISPLAYS LCDs and schedules their flushes
+	@details The group is itself the transport the displays are constructed with.
+		It forwards to the real bus and only switches slave address when the target display
+		changes. Displays should be in shadow mode, GroupFlush() sends their dirty cells
+		in round robin or deadline order. Use from one thread.
+*/
+class HD44780LCDGroup : public HD44780Transport {
+  public:
+	/*! Order in which GroupFlush serves the displays */
+	enum GroupSchedule_e : uint8_t {
+		GroupRoundRobin = 0, /**< Dirty displays in turn, starting after the last one served */
+		GroupDeadline = 1 /**< Displays whose refresh period has expired, earliest deadline first */
+	};
+
+	HD44780LCDGroup(HD44780Transport &bus, GroupSchedule_e schedule = GroupRoundRobin);
+
+	bool I2CBegin(void) override;
+	void I2CEnd(void) override;
+	void I2CSpeedSet(uint16_t speed) override;
+	void I2CAddressSet(uint8_t address) override;
+	uint8_t I2CWrite(const char *buffer, uint32_t length) override;
+	uint8_t I2CRead(char *buffer, uint32_t length) override;
+	void DelayMs(uint32_t ms) override;
+	void DelayUs(uint32_t us) override;
+
+	bool GroupAdd(HD44780PCF8574LCD &display, uint32_t periodMs = 0);
+	uint8_t GroupFlush(uint8_t maxDisplays = GROUP_MAX_DISPLAYS);
+	void GroupAddressInvalidate(void);
+	uint8_t GroupSizeGet(void);
+	HD44780GroupStats GroupStatsGet(void);
+	HD44780GroupDisplayStats GroupDisplayStatsGet(uint8_t index);
+	void GroupStatsReset(void);
+
+	static const uint8_t GROUP_MAX_DISPLAYS = 8; /**< PCF8574 address range 0x20-0x27 */
+
+  private:
+	bool GroupFlushOne(uint8_t index);
+	int8_t GroupIndexOf(int16_t address);
+	uint64_t GroupNowUs(void);
+
+	/*! One display in the group */
+	struct GroupEntry {
+		HD44780PCF8574LCD *Display = nullptr; /**< The display */
+		uint32_t PeriodUs = 0; /**< Deadline order, refresh period */
+		uint64_t DeadlineUs = 0; /**< Deadline order, next flush due */
+		HD44780GroupDisplayStats Stats; /**< Counters */
+	};
+
+	HD44780Transport &_Bus; /**< The real bus transport*/
+	GroupSchedule_e _Schedule = GroupRoundRobin; /**< Flush order*/
+	GroupEntry _Entries[GROUP_MAX_DISPLAYS]; /**< Displays in the group*/
+	uint8_t _NumDisplays = 0; /**< Number of displays in the group*/
+	uint8_t _NextRoundRobin = 0; /**< Round robin order, index to try first*/
+	int16_t _CurrentAddress = -1; /**< Slave address set on the bus, -1 = unknown*/
+	HD44780GroupStats _Stats; /**< Bus counters*/
+	std::chrono::steady_clock::time_point _StatsStart; /**< Start of the throughput window*/
+}; // end of HD44780LCDGroup class
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <cinttypes>
+#include <charconv>
 #include <cstdio> // for size_t
 #include <cstring>
 #include <cmath>
@@ -51,6 +52,9 @@ class Print
     // should be overriden by subclasses with buffering
     virtual int availableForWrite() { return 0; }
 
+    // default to doing nothing, should be overriden by subclasses with buffering
+    virtual void flush() { }
+
     size_t print(const char[]);
     size_t print(char);
     size_t print(int, int = DEC);
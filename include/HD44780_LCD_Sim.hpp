@@ -0,0 +1,119 @@
+/*!
+	@file     HD44780_LCD_Sim.hpp
+	@author   Gavin Lyons
+	@brief    Simulated bus transport for HD44780_LCD library. Emulates the PCF8574
+		pin latch and the HD44780 controller so the library can be run,
+		benchmarked and checked without hardware.
+	@details  URL: https://github.com/gavinlyonsrepo/HD44780_LCD_RPI
+*/
+
+#pragma once
+
+#include <string>
+#include <functional>
+#include "HD44780_LCD_Transport.hpp"
+
+// Section: Structs
+
+/*!
+	@brief Bus and controller counters kept by HD44780TransportSim
+*/
+struct HD44780SimStats {
+	uint32_t Transactions = 0; /**< I2C transactions, reads and writes */
+	uint32_t BytesWritten = 0; /**< Bytes written to the PCF8574 */
+	uint32_t BytesRead = 0; /**< Bytes read from the PCF8574 */
+	uint32_t Commands = 0; /**< Instructions executed by the HD44780 */
+	uint32_t DataWrites = 0; /**< Data bytes written to DDRAM or CGRAM */
+	uint32_t DataReads = 0; /**< Data bytes or busy flag reads from the HD44780 */
+	uint32_t BusyViolations = 0; /**< Bytes received while the HD44780 was still busy */
+	double BusTimeUs = 0; /**< Modelled time on the wire, uS */
+	double DelayTimeUs = 0; /**< Time requested through DelayMs and DelayUs, uS */
+};
+
+// Section: Class's
+
+/*!
+	@brief Software HD44780 + PCF8574 backend
+	@details Time is virtual, delays advance a clock and return at once.
+		Starts in the power on state, 8-bit interface mode.
+*/
+class HD44780TransportSim : public HD44780Transport {
+  public:
+	HD44780TransportSim(uint8_t NumRow, uint8_t NumCol, uint8_t I2Caddress = 0x27);
+
+	bool I2CBegin(void) override;
+	void I2CEnd(void) override;
+	void I2CSpeedSet(uint16_t speed) override;
+	void I2CAddressSet(uint8_t address) override;
+	uint8_t I2CWrite(const char *buffer, uint32_t length) override;
+	uint8_t I2CRead(char *buffer, uint32_t length) override;
+	void DelayMs(uint32_t ms) override;
+	void DelayUs(uint32_t us) override;
+
+	std::string SimLineGet(uint8_t lineNo);
+	std::string SimScreenGet(void);
+	uint8_t SimDDRAMGet(uint8_t address);
+	uint8_t SimCGRAMGet(uint8_t address);
+	uint8_t SimAddressCounterGet(void);
+	uint8_t SimDisplayShiftGet(void);
+	uint8_t SimEntryModeGet(void);
+	uint8_t SimDisplayControlGet(void);
+	bool SimFourBitModeGet(void);
+	bool SimBackLightGet(void);
+	double SimTimeUsGet(void);
+
+	void SimConnectedSet(bool);
+	void SimReadWiredSet(bool);
+	void SimPowerOnReset(void);
+	void SimExecuteHookSet(std::function<void(uint8_t value, bool data)> hook);
+	HD44780SimStats SimStatsGet(void);
+	void SimStatsReset(void);
+
+  private:
+	void SimLatch(uint8_t pins);
+	void SimExecute(uint8_t byte, bool rs);
+	void SimReadDone(bool rs);
+	uint8_t SimReadByte(bool rs);
+	uint8_t SimAddressStep(uint8_t address, bool increment);
+	uint8_t SimCellAddress(uint8_t row, uint8_t col);
+	void SimClock(double us);
+	double SimBitTimeUs(void);
+
+	/*! PCF8574 pin bits, DATA-led-en-rw-rs */
+	enum SimPin_e : uint8_t {
+		SimPinRS = 0x01, /**< Register select */
+		SimPinRW = 0x02, /**< Read / write */
+		SimPinEN = 0x04, /**< Enable */
+		SimPinLED = 0x08 /**< Backlight */
+	};
+
+	uint8_t _NumRowsLCD = 2; /**< number of rows on LCD*/
+	uint8_t _NumColsLCD = 16; /**< number of columns on LCD*/
+	uint8_t _SimAddressI2C = 0x27; /**< I2C address the PCF8574 answers on*/
+	uint8_t _TargetAddressI2C = 0x27; /**< I2C address set by I2CAddressSet*/
+	uint16_t _SimSpeedI2C = 0; /**< 0 = 100K or BCM2835_I2C_CLOCK_DIVIDER value*/
+	bool _SimConnected = true; /**< false = device NACKs every transfer*/
+	bool _SimReadWired = true; /**< false = RW not wired, D7-D4 read back the PCF8574 latch*/
+
+	uint8_t _Pins = 0xFF; /**< PCF8574 output latch, 0xFF at power on*/
+	bool _EightBitMode = true; /**< HD44780 interface data length*/
+	bool _NibblePending = false; /**< 4-bit mode, upper nibble received*/
+	uint8_t _NibbleUpper = 0; /**< 4-bit mode, upper nibble store*/
+	uint8_t _ReadPhase = 0; /**< 4-bit mode read, nibble number*/
+	uint8_t _ReadNibbles = 0xF0; /**< Value the HD44780 drives onto D7-D4 while EN is high*/
+
+	uint8_t _DDRAM[128]; /**< Display data RAM, indexed by address*/
+	uint8_t _CGRAM[64]; /**< Character generator RAM*/
+	uint8_t _AddressCounter = 0; /**< HD44780 address counter*/
+	bool _AddressCGRAM = false; /**< true if the address counter points into CGRAM*/
+	bool _EntryIncrement = true; /**< Entry mode I/D bit*/
+	bool _EntryShift = false; /**< Entry mode S bit*/
+	uint8_t _DisplayShift = 0; /**< Display shift, DDRAM address in visible column 0*/
+	uint8_t _DisplayControl = 0x00; /**< Display control command, D C B bits*/
+	bool _TwoLine = false; /**< Function set N bit*/
+
+	double _TimeUs = 0; /**< Virtual clock, uS*/
+	double _BusyUntilUs = 0; /**< HD44780 busy until this time, uS*/
+	HD44780SimStats _Stats; /**< Bus counters*/
+	std::function<void(uint8_t, bool)> _ExecuteHook; /**< Called for every byte the HD44780 receives, may be empty*/
+}; // end of HD44780TransportSim class
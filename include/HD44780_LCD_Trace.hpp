@@ -0,0 +1,97 @@
+/*!
+	@file     HD44780_LCD_Trace.hpp
+	@author   Gavin Lyons
+	@brief    Bus trace capture and read back for HD44780_LCD library. A recording
+		transport logs every transfer with a timestamp into a compact binary file,
+		which can be replayed into HD44780TransportSim or onto real hardware.
+	@details  URL: https://github.com/gavinlyonsrepo/HD44780_LCD_RPI
+	@note File format, all integers little endian, times are uS since the previous record:
+		-# Header "HD4T" then version byte 1
+		-# Record : type byte, delta time varint(LEB128), payload as HD44780TraceType_e
+*/
+
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include "HD44780_LCD_Transport.hpp"
+
+// Section: Enums + Structs
+
+/*! Trace record types, payload in brackets */
+enum HD44780TraceType_e : uint8_t {
+	HD44780TraceBegin = 1, /**< I2CBegin(result byte) */
+	HD44780TraceEnd = 2, /**< I2CEnd() */
+	HD44780TraceSpeed = 3, /**< I2CSpeedSet(uint16) */
+	HD44780TraceAddress = 4, /**< I2CAddressSet(address byte) */
+	HD44780TraceWrite = 5, /**< I2CWrite(length varint, frame bytes, result byte) */
+	HD44780TraceRead = 6, /**< I2CRead(length varint, bytes read, result byte) */
+	HD44780TraceDelay = 7 /**< DelayMs or DelayUs(uS varint) */
+};
+
+/*!
+	@brief One record of a bus trace
+*/
+struct HD44780TraceRecord {
+	HD44780TraceType_e Type = HD44780TraceBegin; /**< Record type */
+	uint64_t TimeUs = 0; /**< uS since recording started */
+	uint32_t Value = 0; /**< Speed, address or delay uS */
+	uint8_t Result = 0; /**< bcm2835I2CReasonCodes of a begin, write or read */
+	std::string Bytes; /**< Frame bytes written or bytes read */
+};
+
+// Section: Class's
+
+/*!
+	@brief Transport decorator that records every transfer to a trace file
+	@details Everything is passed to the inner transport unchanged. Pass the recorder
+		as the transport of the LCD, e.g. HD44780PCF8574LCD myLCD(2, 16, 0x27, 0, myRecorder);
+		Nothing is recorded until RecordOpen.
+*/
+class HD44780TransportRecord : public HD44780Transport {
+  public:
+	HD44780TransportRecord(HD44780Transport &inner);
+	~HD44780TransportRecord();
+
+	bool I2CBegin(void) override;
+	void I2CEnd(void) override;
+	void I2CSpeedSet(uint16_t speed) override;
+	void I2CAddressSet(uint8_t address) override;
+	uint8_t I2CWrite(const char *buffer, uint32_t length) override;
+	uint8_t I2CRead(char *buffer, uint32_t length) override;
+	void DelayMs(uint32_t ms) override;
+	void DelayUs(uint32_t us) override;
+
+	bool RecordOpen(const std::string &path);
+	void RecordClose(void);
+	bool RecordGet(void);
+	uint32_t RecordCountGet(void);
+
+  private:
+	void RecordHeader(HD44780TraceType_e type);
+	void RecordVarint(uint64_t value);
+	void RecordBytes(const char *buffer, uint32_t length, uint8_t result);
+
+	HD44780Transport &_Inner; /**< Transport the transfers are passed to*/
+	std::ofstream _File; /**< Trace file, closed when not recording*/
+	std::chrono::steady_clock::time_point _Start; /**< Time of RecordOpen*/
+	uint64_t _LastUs = 0; /**< Time of the previous record, uS since _Start*/
+	uint32_t _Count = 0; /**< Records written*/
+}; // end of HD44780TransportRecord class
+
+/*!
+	@brief Reads a trace file written by HD44780TransportRecord, one record at a time
+*/
+class HD44780TraceReader {
+  public:
+	bool TraceOpen(const std::string &path);
+	bool TraceNext(HD44780TraceRecord &record);
+	void TraceClose(void);
+
+  private:
+	bool TraceVarint(uint64_t &value);
+
+	std::ifstream _File; /**< Trace file*/
+	uint64_t _TimeUs = 0; /**< Time of the last record read*/
+}; // end of HD44780TraceReader class
@@ -0,0 +1,111 @@
+/*!
+	@file     HD44780_LCD_Transport.hpp
+	@author   Gavin Lyons
+	@brief    Bus transport interface for HD44780_LCD library, the LCD class talks
+		to the PCF8574 only through this interface.
+	@details  URL: https://github.com/gavinlyonsrepo/HD44780_LCD_RPI
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <bcm2835.h>
+
+// Section: Functions
+
+/*!
+	@brief Retry backoff delay, used by the LCD class and the async worker
+	@param retry 0 for the first retry
+	@param baseMs delay before the second retry, doubled each retry after
+	@param maxMs delay cap
+	@param jitter xorshift32 state, up to 50% is added
+	@return delay mS, 0 for the first retry
+*/
+inline uint16_t HD44780RetryBackoffMs(uint8_t retry, uint16_t baseMs, uint16_t maxMs, uint32_t &jitter)
+{
+	if (retry == 0) return 0;
+
+	uint32_t delay = baseMs;
+	for (uint8_t i = 1; i < retry && delay < maxMs; i++) delay <<= 1;
+	jitter ^= jitter << 13; // xorshift32
+	jitter ^= jitter >> 17;
+	jitter ^= jitter << 5;
+	delay += jitter % (delay / 2 + 1); // up to +50%
+	return (delay > maxMs) ? maxMs : delay;
+}
+
+// Section: Class's
+
+/*!
+	@brief Abstract I2C bus transport used by HD44780PCF8574LCD
+	@details Write and read methods return bcm2835I2CReasonCodes,
+		0x00 = success, so every backend reports errors the same way.
+*/
+class HD44780Transport {
+  public:
+	virtual ~HD44780Transport(){};
+
+	virtual bool I2CBegin(void) = 0;
+	virtual void I2CEnd(void) = 0;
+	virtual void I2CSpeedSet(uint16_t speed) = 0;
+	virtual void I2CAddressSet(uint8_t address) = 0;
+	virtual uint8_t I2CWrite(const char *buffer, uint32_t length) = 0;
+	virtual uint8_t I2CRead(char *buffer, uint32_t length) = 0;
+	virtual void DelayMs(uint32_t ms) = 0;
+	virtual void DelayUs(uint32_t us) = 0;
+}; // end of HD44780Transport class
+
+/*!
+	@brief Transport on the bcm2835 library hardware I2C, the default
+*/
+class HD44780TransportBCM2835 : public HD44780Transport {
+  public:
+	bool I2CBegin(void) override;
+	void I2CEnd(void) override;
+	void I2CSpeedSet(uint16_t speed) override;
+	void I2CAddressSet(uint8_t address) override;
+	uint8_t I2CWrite(const char *buffer, uint32_t length) override;
+	uint8_t I2CRead(char *buffer, uint32_t length) override;
+	void DelayMs(uint32_t ms) override;
+	void DelayUs(uint32_t us) override;
+}; // end of HD44780TransportBCM2835 class
+
+/*!
+	@brief Transport on the Linux kernel i2c-dev interface, /dev/i2c-N
+	@details Runs without root for users in the i2c group and on non-BCM boards.
+		A write is sent as one i2c message in one I2C_RDWR ioctl by default, 
+		see I2CMessageSizeSet for adapters that limit message length.
+		Bus speed is set by the kernel (device tree), I2CSpeedSet does nothing.
+*/
+class HD44780TransportI2CDev : public HD44780Transport {
+  public:
+	HD44780TransportI2CDev(uint8_t busNumber = 1);
+	~HD44780TransportI2CDev();
+
+	bool I2CBegin(void) override;
+	void I2CEnd(void) override;
+	void I2CSpeedSet(uint16_t speed) override;
+	void I2CAddressSet(uint8_t address) override;
+	uint8_t I2CWrite(const char *buffer, uint32_t length) override;
+	uint8_t I2CRead(char *buffer, uint32_t length) override;
+	void DelayMs(uint32_t ms) override;
+	void DelayUs(uint32_t us) override;
+
+	void I2CBusSet(uint8_t busNumber);
+	void I2CDevicePathSet(const std::string &path);
+	std::string I2CDevicePathGet(void);
+	void I2CMessageSizeSet(uint16_t bytes);
+	uint32_t I2CIoctlCountGet(void);
+
+  private:
+	uint8_t I2CErrnoToReason(int error);
+
+	static const uint8_t I2CDEV_MSGS_MAX = 42; /**< I2C_RDWR_IOCTL_MAX_MSGS, kernel limit per ioctl*/
+	static const uint16_t I2CDEV_MSG_LEN_MAX = 8192; /**< Kernel limit on the length of one i2c-dev message*/
+	std::string _DevicePath = "/dev/i2c-1"; /**< i2c-dev device file*/
+	int _FileDescriptor = -1; /**< Open device, -1 = closed*/
+	uint8_t _SlaveAddress = 0x27; /**< I2C address for following transfers*/
+	uint16_t _MessageSize = 0; /**< Max bytes per i2c message, 0 = whole write, one LCD byte = 4 frames*/
+	uint32_t _IoctlCount = 0; /**< Number of I2C_RDWR ioctl system calls made*/
+}; // end of HD44780TransportI2CDev class
@@ -6,6 +6,8 @@
 */
 
 // Section : Includes
+#include <cstdio>
+#include <fstream>
 #include "HD44780_LCD.hpp"
 
 /*!
@@ -26,308 +28,1601 @@ HD44780PCF8574LCD::HD44780PCF8574LCD(uint8_t NumRow, uint8_t NumCol, uint8_t I2C
 {
 	_NumRowsLCD = NumRow;
 	_NumColsLCD = NumCol;
+	_Geometry = HD44780GeometryMake(NumRow, NumCol);
 	_LCDSlaveAddresI2C  = I2Caddress;
 	_LCDSpeedI2C = I2Cspeed;
 }
 
+/*!
+	@brief Constructor for class HD44780PCF8574LCD with a user supplied bus transport
+	@param NumRow number of rows in LCD
+	@param NumCol number of columns in LCD
+	@param I2Caddress  The PCF8574 I2C address, default is 0x27.
+	@param I2Cspeed I2C Bus Clock speed, see other constructor
+	@param transport bus transport used instead of the bcm2835 library, e.g HD44780TransportSim.
+		Must outlive the LCD object.
+*/
+HD44780PCF8574LCD::HD44780PCF8574LCD(uint8_t NumRow, uint8_t NumCol, uint8_t I2Caddress, uint16_t I2Cspeed, HD44780Transport &transport)
+	: HD44780PCF8574LCD(NumRow, NumCol, I2Caddress, I2Cspeed)
+{
+	_Transport = &transport;
+}
+
+/*!
+	@brief Constructor for class HD44780PCF8574LCD selecting the I2C interface
+	@param NumRow number of rows in LCD
+	@param NumCol number of columns in LCD
+	@param I2Caddress  The PCF8574 I2C address, default is 0x27.
+	@param I2Cspeed I2C Bus Clock speed, see other constructor. Ignored by LCDBusI2CDev, 
+		kernel sets the speed.
+	@param busType LCDBusBCM2835 or LCDBusI2CDev
+	@param busNumber LCDBusI2CDev only, N in /dev/i2c-N, default 1
+*/
+HD44780PCF8574LCD::HD44780PCF8574LCD(uint8_t NumRow, uint8_t NumCol, uint8_t I2Caddress, uint16_t I2Cspeed, LCDBusType_e busType, uint8_t busNumber)
+	: HD44780PCF8574LCD(NumRow, NumCol, I2Caddress, I2Cspeed)
+{
+	if (busType == LCDBusI2CDev)
+	{
+		_TransportI2CDev.I2CBusSet(busNumber);
+		_Transport = &_TransportI2CDev;
+	}
+}
+
 // Section : methods
 
 /*!
 	@brief  Send data byte to  LCD via I2C
 	@param data The data byte to send
+	@return LCDStatus_e
 	@note if _DebugON is true, will output data on I2C failures.
 */
-void HD44780PCF8574LCD::LCDSendData(unsigned char data) {
-	
-	bcm2835_i2c_setSlaveAddress(_LCDSlaveAddresI2C);  //i2c address
-	
-	// I2C MASK Byte = DATA-led-en-rw-rs (en=enable rs = reg select)(rw always write)
-	const uint8_t LCDDataByteOn= 0x0D; //enable=1 and rs =1 1101  DATA-led-en-rw-rs
-	const  uint8_t LCDDataByteOff = 0x09; // enable=0 and rs =1 1001 DATA-led-en-rw-rs
-	
-	unsigned char dataNibbleLower, dataNibbleUpper;
-	char dataBufferI2C[4];
-	uint8_t AttemptCount = _I2C_ErrorRetryNum;
-	
-	dataNibbleLower = (data << 4)&0xf0; //select lower nibble by moving it to the upper nibble position
-	dataNibbleUpper = data & 0xf0; //select upper nibble
-	dataBufferI2C[0] = dataNibbleUpper | (LCDDataByteOn & _LCDBackLight); //enable=1 and rs =1 1101  YYYY-X-en-X-rs
-	dataBufferI2C[1] = dataNibbleUpper | (LCDDataByteOff & _LCDBackLight); //enable=0 and rs =1 1001 YYYY-X-en-X-rs
-	dataBufferI2C[2] = dataNibbleLower | (LCDDataByteOn & _LCDBackLight); //enable=1 and rs =1 1101  YYYY-X-en-X-rs
-	dataBufferI2C[3] = dataNibbleLower | (LCDDataByteOff &  _LCDBackLight); //enable=0 and rs =1 1001 YYYY-X-en-X-rs
+uint8_t HD44780PCF8574LCD::LCDSendData(unsigned char data) {
+	LCDBatchData(data);
+	return LCDBatchSend();
+}
 
-	// bcm2835I2CReasonCodes , BCM2835_I2C_REASON_OK 0x00 = Success
-	uint8_t  ReasonCodes = bcm2835_i2c_write(dataBufferI2C, 4);
+/*!
+	@brief  Send command byte to lcd
+	@param cmd command byte
+	@return LCDStatus_e
+	@note if _DebugON == true  ,will output data on I2C failures.
+*/
+uint8_t HD44780PCF8574LCD::LCDSendCmd(unsigned char cmd) {
+	LCDBatchCmd(cmd);
+	return LCDBatchSend();
+}
 
-	// Error handling retransmit
-	while(ReasonCodes != 0)
+/*!
+	@brief  Append a data byte to the batch buffer, sent by LCDBatchSend
+	@param data The data byte to queue
+	@note The batch is sent automatically when full.
+*/
+void HD44780PCF8574LCD::LCDBatchData(uint8_t data) {
+	LCDBatchFrames(data, true);
+}
+
+/*!
+	@brief  Append a command byte to the batch buffer, sent by LCDBatchSend
+	@param cmd The command byte to queue
+	@note Only for commands with the standard execution time(37uS), 
+		clear and home must be sent with LCDSendCmd followed by LCDWaitReady.
+*/
+void HD44780PCF8574LCD::LCDBatchCmd(uint8_t cmd) {
+	LCDBatchFrames(cmd, false);
+}
+
+/*!
+	@brief  Copy the four PCF8574 frames for one byte into the batch buffer
+	@param value data or command byte
+	@param data true = data byte(rs=1), false = command byte(rs=0)
+	@note frames come from the compile time tables in HD44780_LCD_Frames.hpp
+*/
+void HD44780PCF8574LCD::LCDBatchFrames(uint8_t value, bool data) {
+	if (_BatchLen + 4U > sizeof(_BatchBufferI2C)) _BatchError = LCDBatchSend();
+	if (_BatchLen == 0) LCDBatchMark();
+
+	const HD44780FrameTable &table = HD44780FrameTables[data][_LCDBackLight == LCDBackLightOnMask];
+	memcpy(&_BatchBufferI2C[_BatchLen], table.Frames[value], 4);
+	_BatchLen += 4;
+	data ? _Stats.DataBytes++ : _Stats.Commands++;
+	data ? LCDTrackData(1) : LCDTrackCmd(value);
+}
+
+/*!
+	@brief  Append a run of data bytes to the batch buffer, sent by LCDBatchSend
+	@param data The data bytes to queue
+	@param length number of bytes
+	@note Table is looked up once for the run, the copy loop can be vectorised.
+*/
+void HD44780PCF8574LCD::LCDBatchDataRun(const uint8_t *data, size_t length) {
+	const HD44780FrameTable &table = HD44780FrameTables[1][_LCDBackLight == LCDBackLightOnMask];
+	_Stats.DataBytes += length;
+	while (length > 0)
 	{
-		if (_DebugON == true)
-		{
-			std::cout << "Error 601 I2C  Data bcm2835I2CReasonCodes : " << +ReasonCodes << std::endl;
-			std::cout << "Attempt Count: " << +AttemptCount << std::endl;
-		}
-		bcm2835_delay(_I2C_ErrorDelay );
-		ReasonCodes = bcm2835_i2c_write(dataBufferI2C, 4); // retransmit
-		_I2C_ErrorFlag = ReasonCodes;
-		AttemptCount--;
-		if (AttemptCount == 0) break;
+		if (_BatchLen + 4U > sizeof(_BatchBufferI2C)) _BatchError = LCDBatchSend();
+		if (_BatchLen == 0) LCDBatchMark();
+		size_t room = (sizeof(_BatchBufferI2C) - _BatchLen) / 4;
+		size_t count = (length < room) ? length : room;
+		char *frames = &_BatchBufferI2C[_BatchLen];
+		for (size_t i = 0; i < count; i++)
+			memcpy(&frames[i * 4], table.Frames[data[i]], 4);
+		_BatchLen += count * 4;
+		LCDTrackData(count); // per part, a full buffer is sent between parts
+		data += count;
+		length -= count;
 	}
-	_I2C_ErrorFlag = ReasonCodes;
 }
 
 /*!
-	@brief  Send command byte to lcd
-	@param cmd command byte
-	@note if _DebugON == true  ,will output data on I2C failures.
+	@brief  Send the batch buffer to the LCD in a single I2C transaction
+	@return LCDStatus_e, bcm2835I2CReasonCodes or LCDStatusBreakerOpen, 0x00 = Success.
+		Includes the status of batches sent automatically when the buffer filled up.
+	@note if _DebugON is true, will output data on I2C failures.
+		On failure the whole batch is retransmitted, delays as set by LCDRetryPolicySet.
+		In async mode the worker retransmits, failures are returned by the next call, see LCDAsyncStatus.
+		Frames before the failure may have reached the display, so a set address command
+		for where the batch started goes ahead of the retransmit. If that is not known the
+		tracked cursor and the shadow glass are marked unknown after any retry.
 */
-void HD44780PCF8574LCD::LCDSendCmd(unsigned char cmd) {
-	
-	bcm2835_i2c_setSlaveAddress(_LCDSlaveAddresI2C);  //i2c address
-	
-	// I2C MASK Byte = COMD-led-en-rw-rs (en=enable rs = reg select)(rw always write)
-	const uint8_t LCDCmdByteOn = 0x0C;  // enable=1 and rs =0 1100 COMD-led-en-rw-rs 
-	const uint8_t LCDCmdByteOff = 0x08; // enable=0 and rs =0 1000 COMD-led-en-rw-rs 
-	
+uint8_t HD44780PCF8574LCD::LCDBatchSend(void) {
+	uint8_t earlier = _BatchError;
+	_BatchError = LCDStatusOK;
+	if (_BatchLen == 0) return earlier;
+	if (_BreakerOpen == true && LCDBreakerProbe() == false)
+	{
+		_BatchLen = 0;
+		_CursorKnown = false;
+		_CGRAMAddress = HD44780AddressNone;
+		_Stats.BreakerRejects++;
+		_I2C_ErrorFlag = LCDStatusBreakerOpen;
+		return earlier | LCDStatusBreakerOpen;
+	}
+
+	LCDWaitPay();
+	_Transport->I2CAddressSet(_LCDSlaveAddresI2C);  //i2c address
+	if (_TransportAsync != nullptr && _BatchStartCmd != 0) // the worker does the retries
+		_TransportAsync->AsyncRetryPrefixSet(
+			reinterpret_cast<const char *>(HD44780FrameTables[0][_LCDBackLight == LCDBackLightOnMask].Frames[_BatchStartCmd]), 4);
+
+	std::chrono::steady_clock::time_point start;
+	if (_StatsLatencyON == true) start = std::chrono::steady_clock::now();
 
-	unsigned char cmdNibbleLower, cmdNibbleUpper;
-	char cmdBufferI2C[4];
 	uint8_t AttemptCount = _I2C_ErrorRetryNum;
-	
-	cmdNibbleLower = (cmd << 4)&0xf0; //select lower nibble by moving it to the upper nibble position
-	cmdNibbleUpper = cmd & 0xf0; //select upper nibble
-	cmdBufferI2C[0] = cmdNibbleUpper | (LCDCmdByteOn & _LCDBackLight); // YYYY-1100 YYYY-led-en-rw-rs ,enable=1 and rs =0
-	cmdBufferI2C[1] = cmdNibbleUpper | (LCDCmdByteOff & _LCDBackLight); // YYYY-1000 YYYY-led-en-rw-rs ,enable=0 and rs =0
-	cmdBufferI2C[2] = cmdNibbleLower | (LCDCmdByteOn & _LCDBackLight); // YYYY-1100 YYYY-led-en-rw-rs ,enable=1 and rs =0
-	cmdBufferI2C[3] = cmdNibbleLower | (LCDCmdByteOff & _LCDBackLight); // YYYY-1000 YYYY-led-en-rw-rs ,enable=0 and rs =0
-
-	// bcm2835I2CReasonCodes, BCM2835_I2C_REASON_OK 0x00 = Success
-	uint8_t ReasonCodes = bcm2835_i2c_write(cmdBufferI2C, 4);
+	// bcm2835I2CReasonCodes , BCM2835_I2C_REASON_OK 0x00 = Success
+	uint8_t ReasonCodes = _Transport->I2CWrite(_BatchBufferI2C, _BatchLen);
+	_Stats.Transactions++;
+	_Stats.BytesWritten += _BatchLen;
+
+	// Error handling retransmit, with the address counter set back to the start of the batch
+	const char *retryBuffer = _BatchBufferI2C;
+	uint32_t retryLength = _BatchLen;
+	char retryFrames[4 + sizeof(_BatchBufferI2C)];
+	if (ReasonCodes != 0 && _BatchStartCmd != 0)
+	{
+		memcpy(retryFrames, HD44780FrameTables[0][_LCDBackLight == LCDBackLightOnMask].Frames[_BatchStartCmd], 4);
+		memcpy(&retryFrames[4], _BatchBufferI2C, _BatchLen);
+		retryBuffer = retryFrames;
+		retryLength = _BatchLen + 4;
+	}
 	while(ReasonCodes != 0)
 	{
+		LCDStatsError(ReasonCodes);
+		if (AttemptCount == 0) break;
 		if (_DebugON == true)
 		{
-			std::cout << "Error 602: I2C Command bcm2835I2CReasonCodes : " << +ReasonCodes << std::endl;
-			std::cout << "Attempt Count : " << +AttemptCount<< std::endl;
+			std::cout << "Error 601 I2C  write bcm2835I2CReasonCodes : " << +ReasonCodes << std::endl;
+			std::cout << "Attempt Count: " << +AttemptCount << std::endl;
 		}
-		bcm2835_delay(_I2C_ErrorDelay);
-		ReasonCodes = bcm2835_i2c_write(cmdBufferI2C,4); // retransmit
-		_I2C_ErrorFlag = ReasonCodes;
+		uint16_t delay = LCDRetryDelay(_I2C_ErrorRetryNum - AttemptCount);
+		if (delay > 0) _Transport->DelayMs(delay);
+		ReasonCodes = _Transport->I2CWrite(retryBuffer, retryLength); // retransmit
+		_Stats.Transactions++;
+		_Stats.Retries++;
 		AttemptCount--;
-		if (AttemptCount== 0) break;
 	}
+
+	if (_StatsLatencyON == true)
+	{
+		uint32_t latency = std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - start).count();
+		uint8_t bucket = (latency < 2) ? 0 : 31 - __builtin_clz(latency); // floor(log2)
+		if (bucket >= HD44780LCDStats::LATENCY_BUCKETS) bucket = HD44780LCDStats::LATENCY_BUCKETS - 1;
+		_Stats.LatencyHistogram[bucket]++;
+		_Stats.LatencyTotalUs += latency;
+		if (latency > _Stats.LatencyMaxUs) _Stats.LatencyMaxUs = latency;
+	}
+
+	_BatchLen = 0;
+	if (_TransportAsync != nullptr) return earlier | LCDAsyncStatus(); // the post always succeeds
 	_I2C_ErrorFlag = ReasonCodes;
+	if (AttemptCount != _I2C_ErrorRetryNum) // retried, part of a failed write may have been latched
+	{
+		_HealthSuspect = true; // half a byte puts the 4-bit interface out of step
+		if (_BatchStartCmd == 0)
+		{
+			_CursorKnown = false;
+			_CGRAMAddress = HD44780AddressNone;
+			_ShadowGlassValid = false;
+		}
+	}
+	if (ReasonCodes != 0) 
+	{
+		_CursorKnown = false;
+		_CGRAMAddress = HD44780AddressNone;
+		_HealthSuspect = true; // display may have been power cycled
+		_Stats.Failures++;
+		LCDBreakerFailure();
+	}
+	else
+	{
+		_BreakerFailures = 0;
+	}
+	return earlier | ReasonCodes;
 }
 
 /*!
-	@brief  Clear a line by writing spaces to every position
-	@param lineNo LCDLineNumber_e enum lineNo  1-4
+	@brief  Note where the address counter is as a batch starts, for LCDBatchSend to set it
+		back ahead of a retransmit
+*/
+void HD44780PCF8574LCD::LCDBatchMark(void) {
+	if (_CursorKnown == true) _BatchStartCmd = 0x80 | _CursorAddress;
+	else if (_CGRAMAddress != HD44780AddressNone) _BatchStartCmd = 0x40 | _CGRAMAddress;
+	else _BatchStartCmd = 0;
+}
+
+/*!
+	@brief  Append a set DDRAM address command, skipped if the address counter is already there
+	@param cmd set DDRAM address command byte, 0x80 | address
 */
-void HD44780PCF8574LCD::LCDClearLine(LCDLineNumber_e lineNo) {
+void HD44780PCF8574LCD::LCDBatchAddress(uint8_t cmd) {
+	if (_CursorKnown == true && (cmd & 0x7F) == _CursorAddress) return;
+	LCDBatchCmd(cmd);
+}
 
-	switch (lineNo) {
-		case LCDLineNumberOne:LCDSendCmd(LCDLineAddressOne); break;
-		case LCDLineNumberTwo:LCDSendCmd(LCDLineAddressTwo); break;
-		case LCDLineNumberThree:
-			switch (_NumColsLCD)
+/*!
+	@brief  Wait for the command just sent to finish, as set by LCDWaitModeSet
+	@param fixedMs delay in LCDWaitFixed mode
+	@param execUs datasheet execution time, delay in LCDWaitTimed mode
+	@param pollable false if the busy flag can not be read yet(during LCDInit), timed wait used
+	@note In LCDWaitBusyFlag mode a failed poll drops to LCDWaitTimed for good.
+*/
+void HD44780PCF8574LCD::LCDWaitReady(uint16_t fixedMs, uint16_t execUs, bool pollable) {
+	if (_BreakerOpen == true) return; // nothing was sent
+	switch (_WaitMode)
+	{
+		case LCDWaitFixed:
+			_Transport->DelayMs(fixedMs);
+		break;
+		case LCDWaitBusyFlag:
+			if (pollable == false) 
 			{
-				case 16: LCDSendCmd(LCDLineAddress3Col16); break;
-				case 20: LCDSendCmd(LCDLineAddress3Col20); break;
+				_Transport->DelayUs(execUs);
+				break;
 			}
+			if (LCDBusyFlagPoll() == true) break;
+			if (_DebugON == true)
+				std::cout << "Warning 611: busy flag read failed, using timed waits" << std::endl;
+			_WaitMode = LCDWaitTimed;
+			_Transport->DelayUs(execUs);
+		break;
+		case LCDWaitTimed:
+			_Transport->DelayUs(execUs);
 		break;
-		case LCDLineNumberFour:
-			switch (_NumColsLCD)
+		case LCDWaitDeferred:
+			if (_TransportAsync != nullptr) // queued work has not been sent yet, the clock can not tell
 			{
-				case 16: LCDSendCmd(LCDLineAddress4Col16); break;
-				case 20: LCDSendCmd(LCDLineAddress4Col20); break;
+				_Transport->DelayUs(execUs);
+				break;
 			}
+			_WaitOwedUs = execUs;
+			_WaitOwedSince = std::chrono::steady_clock::now();
 		break;
 	}
+}
+
+/*!
+	@brief  LCDWaitDeferred, delay for whatever is left of the owed wait before a transfer
+	@details Time spent by the caller since the command counts towards the wait,
+		only the remainder is passed to the transport.
+*/
+void HD44780PCF8574LCD::LCDWaitPay(void) {
+	uint32_t owed = LCDWaitOwedUsGet();
+	_WaitOwedUs = 0;
+	if (owed > 0) _Transport->DelayUs(owed);
+}
+
+/*!
+	@brief  Read the HD44780 busy flag until it clears
+	@return true when the controller is ready, 
+		false on a read error or if it stays busy for LCD_BUSY_POLL_MAX reads (RW not wired)
+	@details D7-D4 written high so the PCF8574 releases them, RW high, then the
+		upper nibble (BF + AC6-4) is read while EN is high. 
+		The lower nibble is clocked out to keep the 4-bit interface in step.
+*/
+bool HD44780PCF8574LCD::LCDBusyFlagPoll(void) {
+	const char LCDReadEnOff = 0xF2 | (_LCDBackLight & HD44780BackLightBit); // D7-D4 released, rw=1 en=0 rs=0
+	const char LCDReadEnOn = LCDReadEnOff | 0x04; // en=1
+	const char upper[2] = {LCDReadEnOff, LCDReadEnOn};
+	const char lower[3] = {LCDReadEnOff, LCDReadEnOn, LCDReadEnOff};
+	char pins = 0;
+
+	_Transport->I2CAddressSet(_LCDSlaveAddresI2C);
+	for (uint8_t poll = 0; poll < LCD_BUSY_POLL_MAX; poll++)
+	{
+		_Stats.Transactions += 3;
+		if (_Transport->I2CWrite(upper, sizeof(upper)) != 0) return false;
+		if (_Transport->I2CRead(&pins, 1) != 0) return false;
+		if (_Transport->I2CWrite(lower, sizeof(lower)) != 0) return false;
+		if ((pins & 0x80) == 0) return true;
+	}
+	return false;
+}
+
+/*!
+	@brief  Read the HD44780 busy flag and address counter, both nibbles
+	@param status set to BF + AC6-0
+	@return false on a read error
+	@note Only meaningful with RW wired, else the PCF8574 reads back 0xFF.
+*/
+bool HD44780PCF8574LCD::LCDReadStatus(uint8_t &status) {
+	const char LCDReadEnOff = 0xF2 | (_LCDBackLight & HD44780BackLightBit); // D7-D4 released, rw=1 en=0 rs=0
+	const char nibble[2] = {LCDReadEnOff, static_cast<char>(LCDReadEnOff | 0x04)}; // en low then high
+	char upper = 0, lower = 0;
+
+	_Transport->I2CAddressSet(_LCDSlaveAddresI2C);
+	_Stats.Transactions += 5;
+	if (_Transport->I2CWrite(nibble, sizeof(nibble)) != 0 || _Transport->I2CRead(&upper, 1) != 0) return false;
+	if (_Transport->I2CWrite(nibble, sizeof(nibble)) != 0 || _Transport->I2CRead(&lower, 1) != 0) return false;
+	if (_Transport->I2CWrite(&LCDReadEnOff, 1) != 0) return false;
+	status = (upper & 0xF0) | ((lower >> 4) & 0x0F);
+	return true;
+}
+
+/*!
+	@brief  Count one failed write attempt by bcm2835 reason code
+	@param reasonCode bcm2835I2CReasonCodes
+*/
+void HD44780PCF8574LCD::LCDStatsError(uint8_t reasonCode) {
+	switch (reasonCode)
+	{
+		case BCM2835_I2C_REASON_ERROR_NACK: _Stats.ErrorsNack++; break;
+		case BCM2835_I2C_REASON_ERROR_CLKT: _Stats.ErrorsClkt++; break;
+		case BCM2835_I2C_REASON_ERROR_DATA: _Stats.ErrorsData++; break;
+		case BCM2835_I2C_REASON_ERROR_TIMEOUT: _Stats.ErrorsTimeout++; break;
+		default: break;
+	}
+}
+
+/*!
+	@brief  Delay before a retry attempt
+	@param retry 0 for the first retry
+	@return delay mS
+*/
+uint16_t HD44780PCF8574LCD::LCDRetryDelay(uint8_t retry) {
+	if (_RetryPolicy == LCDRetryFixed) return _I2C_ErrorDelay;
+	return HD44780RetryBackoffMs(retry, _RetryBaseMs, _RetryMaxMs, _RetryJitter);
+}
+
+/*!
+	@brief  While the breaker is open, probe the display with LCDCheckConnection when due
+	@return true if the probe succeeded and the breaker closed
+	@details On recovery the tracked cursor and the shadow glass are marked unknown,
+		so the next GOTO and flush send everything again.
+*/
+bool HD44780PCF8574LCD::LCDBreakerProbe(void) {
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (now < _BreakerProbeTime) return false;
+	_BreakerProbeTime = now + std::chrono::milliseconds(_BreakerProbeMs);
+	if (LCDCheckConnection() != 0) return false;
+
+	if (_DebugON == true) std::cout << "Circuit breaker closed, display answered probe" << std::endl;
+	_BreakerOpen = false;
+	_BreakerFailures = 0;
+	if (_TransportAsync != nullptr) // writes dropped by the worker while open are not reported
+	{
+		_TransportAsync->AsyncBreakerReset();
+		_AsyncErrorsSeen = _TransportAsync->AsyncErrorCountGet();
+	}
+	_CursorKnown = false;
+	_CGRAMAddress = HD44780AddressNone;
+	_ShadowGlassValid = false;
+	_HealthSuspect = true;
+	return true;
+}
+
+/*!
+	@brief  Count a transfer that failed after all retries, open the breaker at the threshold
+*/
+void HD44780PCF8574LCD::LCDBreakerFailure(void) {
+	if (_BreakerThreshold == 0 || _BreakerOpen == true) return;
+	if (++_BreakerFailures < _BreakerThreshold) return;
+	LCDBreakerTrip();
+}
+
+/*!
+	@brief  Open the breaker
+*/
+void HD44780PCF8574LCD::LCDBreakerTrip(void) {
+	if (_DebugON == true) 
+		std::cout << "Error 612: circuit breaker open after failures : " << +_BreakerFailures << std::endl;
+	_BreakerOpen = true;
+	_Stats.BreakerTrips++;
+	_BreakerProbeTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(_BreakerProbeMs);
+}
+
+/*!
+	@brief  Set the delays between retry attempts of a failed transfer
+	@param policy LCDRetryFixed, LCDI2CErrorTimeoutSet delay every time(default) or
+		LCDRetryBackoff, immediate retry then baseDelayMs doubling each retry, plus up to 50% jitter
+	@param baseDelayMs backoff, delay before the second retry
+	@param maxDelayMs backoff, delay cap
+	@note number of retries is set by LCDI2CErrorRetryNumSet
+*/
+void HD44780PCF8574LCD::LCDRetryPolicySet(LCDRetryPolicy_e policy, uint16_t baseDelayMs, uint16_t maxDelayMs) {
+	_RetryPolicy = policy;
+	_RetryBaseMs = (baseDelayMs == 0) ? 1 : baseDelayMs;
+	_RetryMaxMs = maxDelayMs;
+	LCDAsyncPolicySet();
+}
+
+/*!
+	@brief  Get the retry policy
+	@return LCDRetryPolicy_e
+*/
+HD44780PCF8574LCD::LCDRetryPolicy_e HD44780PCF8574LCD::LCDRetryPolicyGet(void) { return _RetryPolicy;}
+
+/*!
+	@brief  Set the circuit breaker
+	@param failureThreshold consecutive failed transfers(after retries) that open the breaker, 0 = off(default)
+	@param probeIntervalMs while open, time between LCDCheckConnection probes
+	@details While open every transfer returns LCDStatusBreakerOpen at once, without bus traffic 
+		or delays. A transfer made after the probe interval probes first and is sent if the display answers.
+		A display that lost power must be re-initialised with LCDInit after the breaker closes.
+*/
+void HD44780PCF8574LCD::LCDBreakerSet(uint8_t failureThreshold, uint32_t probeIntervalMs) {
+	_BreakerThreshold = failureThreshold;
+	_BreakerProbeMs = probeIntervalMs;
+	if (failureThreshold == 0) _BreakerOpen = false;
+	_BreakerFailures = 0;
+	if (_TransportAsync != nullptr) _TransportAsync->AsyncBreakerReset();
+	LCDAsyncPolicySet();
+}
+
+/*!
+	@brief  Get the circuit breaker state
+	@return true if open, transfers are being rejected
+*/
+bool HD44780PCF8574LCD::LCDBreakerOpenGet(void) { return _BreakerOpen;}
+
+/*!
+	@brief  Turn the connection health check on and off
+	@param intervalMs time between checks, run from flush() and LCDHealthTick. 0 = off(default)
+	@details A check is also run at the next tick after any failed transfer, not waiting 
+		for the interval, as a display that drops off the bus has usually lost power.
+*/
+void HD44780PCF8574LCD::LCDHealthSet(uint32_t intervalMs) {
+	_HealthIntervalMs = intervalMs;
+	_HealthStatusRead = true;
+	_HealthNext = std::chrono::steady_clock::now() + std::chrono::milliseconds(intervalMs);
+}
+
+/*!
+	@brief  Get the health check interval
+	@return mS, 0 = off
+*/
+uint32_t HD44780PCF8574LCD::LCDHealthGet(void) { return _HealthIntervalMs;}
+
+/*!
+	@brief  Run the health check if due, call often from the main loop when not using flush()
+	@return true if the display was found reset and has been recovered
+	@details Never waits unless a recovery is needed.
+*/
+bool HD44780PCF8574LCD::LCDHealthTick(void) {
+	if (_HealthIntervalMs == 0) return false;
+	if (_HealthSuspect == false && std::chrono::steady_clock::now() < _HealthNext) return false;
+	return (LCDHealthCheck() == LCDHealthRecovered);
+}
+
+/*!
+	@brief  Check the display is still the one the driver set up, recover it if not
+	@return LCDHealth_e
+	@details One byte PCF8574 read, the driver never leaves EN high so reading it high means 
+		the expander (and on a shared supply the HD44780) was power cycled. 
+		Then, with RW wired, an address is set and read back(LCDHealthProbe), a controller
+		reset or a 4-bit interface a nibble out of step takes it as other commands.
+		Without RW wired a failed transfer since the last check is taken as a reset.
+		On recovery see LCDHealthRecover, the probe is run again after it and LCDHealthLost
+		returned if the display is still not in step. Time taken is in LCDStatsGet.
+*/
+HD44780PCF8574LCD::LCDHealth_e HD44780PCF8574LCD::LCDHealthCheck(void) {
+	_HealthNext = std::chrono::steady_clock::now() + std::chrono::milliseconds(_HealthIntervalMs);
+	if (_BreakerOpen == true) return LCDHealthLost; // checked again once the breaker probe closes it
+
+	char pins = 0;
+	LCDWaitPay();
+	_Transport->I2CAddressSet(_LCDSlaveAddresI2C);
+	_Stats.Transactions++;
+	_Stats.HealthChecks++;
+	if (_Transport->I2CRead(&pins, 1) != 0)
+	{
+		_HealthSuspect = true;
+		return LCDHealthLost;
+	}
+	bool powerCycled = (pins & 0x04); // PCF8574 powers up with every pin high
+	bool reset = powerCycled, verified = false;
+
+	if (reset == false && _HealthStatusRead == true) reset = (LCDHealthProbe(verified) == false && verified == true);
+	if (verified == false && _HealthSuspect == true) reset = true;
+	_HealthSuspect = false;
+	if (reset == false) return LCDHealthOK;
+
+	LCDHealthRecover(powerCycled);
+	bool inStep = (_HealthStatusRead == false || LCDHealthProbe(verified) == true);
+	if (inStep == false && _HealthStatusRead == true) // found RW not wired is not a failure
+	{
+		if (_DebugON == true) std::cout << "Error 615: display still out of step after re-initialising" << std::endl;
+		_HealthSuspect = true; // tried again at the next tick
+		return LCDHealthLost;
+	}
+	return LCDHealthRecovered;
+}
+
+/*!
+	@brief  Health check read back, LCDAttachProbe with the tracked cursor put back after
+	@param verified set true if the controller answered(RW wired, not busy, no transfer error)
+	@return true if the address read back matches
+*/
+bool HD44780PCF8574LCD::LCDHealthProbe(bool &verified) {
+	uint8_t cursorAddress = _CursorAddress, status = 0xFF;
+	bool cursorKnown = _CursorKnown;
+	bool inStep = LCDAttachProbe(status);
+	verified = ((status & 0x80) == 0);
+	if (status == 0xFF) _HealthStatusRead = false; // RW not wired, always reads busy
+	if (inStep == true && cursorKnown == true)
+	{
+		LCDBatchAddress(0x80 | cursorAddress);
+		LCDBatchSend();
+	}
+	return inStep;
+}
+
+/*!
+	@brief  Re-initialise the display and replay the driver state
+	@param powerCycled true = wait the power on time first
+	@details Resynchronises the interface, which sends the tracked display control and entry
+		mode, then every CGRAM slot loaded. Shadow mode replays the whole buffer, else the
+		screen is cleared as its contents are unknown. A running marquee is reloaded.
+*/
+void HD44780PCF8574LCD::LCDHealthRecover(bool powerCycled) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (_DebugON == true) std::cout << "Error 613: display reset or out of step, re-initialising" << std::endl;
+
+	if (powerCycled == true) _Transport->DelayMs(15); // power on
+	LCDResync(); // sends the tracked display control and entry mode
+	for (uint8_t slot = 0; slot < LCD_CGRAM_SLOTS; slot++)
+	{
+		if ((_CGRAMKnown & (1 << slot)) == 0) continue;
+		LCDBatchCmd(0x40 | (slot << 3));
+		LCDBatchDataRun(&_CGRAMMirror[slot * 8], 8);
+	}
+	LCDBatchSend();
+	if (_ShadowON == true)
+	{
+		_ShadowGlassValid = false;
+		flush();
+	}
+	else
+	{
+		LCDSendCmd(LCDCmdClearScreen);
+		LCDWaitReady(3, LCDExecTimeLongUs);
+	}
+	if (_MarqueeON == true)
+	{
+		_MarqueeStep = 0; // home left the display shift at 0
+		_MarqueeLoaded = 0;
+		LCDMarqueeLoad(LCD_DDRAM_LINE);
+		LCDBatchSend();
+	}
+
+	uint32_t recoveryUs = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - start).count();
+	_Stats.HealthRecoveries++;
+	_Stats.RecoveryLastUs = recoveryUs;
+	if (recoveryUs > _Stats.RecoveryMaxUs) _Stats.RecoveryMaxUs = recoveryUs;
+}
+
+/*!
+	@brief  Get a snapshot of the driver counters
+	@return copy of the counters
+	@note Counters are always kept, the latency histogram only when LCDStatsLatencySet(true).
+		In async mode a transfer is the post into the ring, failures are the writes the worker gave up on.
+*/
+HD44780LCDStats HD44780PCF8574LCD::LCDStatsGet(void) { return _Stats;}
+
+/*!
+	@brief  Zero the driver counters
+*/
+void HD44780PCF8574LCD::LCDStatsReset(void) { _Stats = HD44780LCDStats();}
+
+/*!
+	@brief  Turn the transfer latency histogram on and off
+	@param OnOff true = time every transfer, costs two clock reads per transfer
+*/
+void HD44780PCF8574LCD::LCDStatsLatencySet(bool OnOff) { _StatsLatencyON = OnOff;}
+
+/*!
+	@brief  Set how the driver waits for slow commands (clear, home, init ...)
+	@param mode LCDWaitFixed, LCDWaitTimed, LCDWaitBusyFlag or LCDWaitDeferred
+	@note LCDWaitBusyFlag needs the backpack RW pin wired to the PCF8574, 
+		if reads fail the mode drops to LCDWaitTimed, see LCDWaitModeGet.
+		In async mode every busy flag read waits for the ring to drain, LCDWaitTimed suits it better.
+*/
+void HD44780PCF8574LCD::LCDWaitModeSet(LCDWaitMode_e mode) { _WaitMode = mode;}
+
+/*!
+	@brief  Get the wait mode
+	@return LCDWaitMode_e, LCDWaitTimed if busy flag reads have failed
+*/
+HD44780PCF8574LCD::LCDWaitMode_e HD44780PCF8574LCD::LCDWaitModeGet(void) { return _WaitMode;}
+
+/*!
+	@brief  Get the wait still owed in LCDWaitDeferred mode
+	@return uS until the last slow command has finished, 0 if the display is ready
+	@details A caller with other work, e.g. HD44780Scheduler, can do it for this long
+		instead of the next transfer waiting it out.
+*/
+uint32_t HD44780PCF8574LCD::LCDWaitOwedUsGet(void)
+{
+	if (_WaitOwedUs == 0) return 0;
+	uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - _WaitOwedSince).count();
+	return (elapsed >= _WaitOwedUs) ? 0 : _WaitOwedUs - elapsed;
+}
+
+/*!
+	@brief  Follow the HD44780 address counter through a command
+	@param cmd command byte being sent
+	@details set DDRAM address, clear, home and cursor shift move the address counter. 
+		set CGRAM address points it into CGRAM, so DDRAM position becomes unknown.
+*/
+void HD44780PCF8574LCD::LCDTrackCmd(uint8_t cmd) {
+	if (cmd & 0x80) // Set DDRAM address
+	{
+		_CursorAddress = cmd & 0x7F;
+		_CursorKnown = true;
+		_CGRAMAddress = HD44780AddressNone;
+	}
+	else if (cmd & 0x40) // Set CGRAM address
+	{
+		_CursorKnown = false;
+		_CGRAMAddress = cmd & 0x3F;
+	}
+	else if ((cmd & 0xF8) == 0x10) // Cursor shift
+	{
+		_CursorAddress = LCDAddressStep(_CursorAddress, cmd & 0x04);
+		_CGRAMAddress = HD44780AddressNone;
+	}
+	else if ((cmd & 0xF8) == 0x18) // Display shift, address counter left alone
+	{
+		_DisplayShift = (cmd & 0x04) ? (_DisplayShift + LCD_DDRAM_LINE - 1) % LCD_DDRAM_LINE
+			: (_DisplayShift + 1) % LCD_DDRAM_LINE;
+	}
+	else if ((cmd & 0xF8) == 0x08) // Display control
+	{
+		_DisplayControl = cmd;
+	}
+	else if ((cmd & 0xFC) == 0x04) // Entry mode
+	{
+		_EntryIncrement = (cmd & 0x02);
+		_EntryMode = cmd;
+	}
+	else if ((cmd & 0xFE) == 0x02) // Home, also undoes display shift
+	{
+		_CursorAddress = 0;
+		_CursorKnown = true;
+		_CGRAMAddress = HD44780AddressNone;
+		_DisplayShift = 0;
+		if (_PageComposing == false) _PageOffset = 0; // page 0 in view
+	}
+	else if (cmd == 0x01) // Clear, also sets increment mode and undoes display shift
+	{
+		_CursorAddress = 0;
+		_CursorKnown = true;
+		_CGRAMAddress = HD44780AddressNone;
+		_EntryIncrement = true;
+		_EntryMode |= 0x02; // shift bit kept
+		_DisplayShift = 0;
+		if (_PageComposing == false) _PageOffset = 0;
+	}
+}
+
+/*!
+	@brief  Follow the HD44780 address counter through data writes
+	@param count number of data bytes being sent
+	@note In CGRAM the address counter wraps at 64.
+*/
+void HD44780PCF8574LCD::LCDTrackData(size_t count) {
+	if (_CursorKnown == false)
+	{
+		if (_CGRAMAddress == HD44780AddressNone) return;
+		_CGRAMAddress = (_EntryIncrement ? _CGRAMAddress + count : _CGRAMAddress - count) & 0x3F;
+		return;
+	}
+	while (count--) _CursorAddress = LCDAddressStep(_CursorAddress, _EntryIncrement);
+}
+
+/*!
+	@brief  Next DDRAM address counter value, with the HD44780 two line wrap
+	@param address current address
+	@param increment true = increment, false = decrement
+	@return new address
+*/
+uint8_t HD44780PCF8574LCD::LCDAddressStep(uint8_t address, bool increment) {
+	if (increment)
+	{
+		if (address == 0x27) return 0x40;
+		if (address == 0x67) return 0x00;
+		return address + 1;
+	}
+	if (address == 0x00) return 0x67;
+	if (address == 0x40) return 0x27;
+	return address - 1;
+}
+
+/*!
+	@brief  Clear a line by writing spaces to every position
+	@param lineNo LCDLineNumber_e enum lineNo  1-4
+	@return LCDStatus_e
+*/
+uint8_t HD44780PCF8574LCD::LCDClearLine(LCDLineNumber_e lineNo) {
+	if (_ShadowON == true)
+	{
+		if (lineNo <= _NumRowsLCD) LCDShadowFill(lineNo - 1);
+		return LCDStatusOK;
+	}
+
+	uint8_t row = lineNo - 1;
+	if (LCDCellAddress(row, 0) == HD44780AddressNone) return LCDStatusOK;
+
+	for (uint8_t col = 0; col < _NumColsLCD; col++) {
+		LCDBatchAddress(0x80 | LCDCellAddress(row, col)); // sent at column 0 and the 16x1 split only
+		LCDBatchData(' ');
+	}
+	return LCDBatchSend();
+}
+
+/*!
+	@brief  Clear screen by writing spaces to every position
+	@return LCDStatus_e, bits of all the transfers
+	@note : See also LCDClearScreenCmd for software command clear alternative.
+*/
+uint8_t HD44780PCF8574LCD::LCDClearScreen(void) {
+	uint8_t status = LCDStatusOK;
+	if (_NumRowsLCD < 1 || _NumRowsLCD >4)
+	{
+		if (_DebugON == true)
+		{
+			std::cout << "Error 603 : Number of rows invalid, must be:" << _NumRowsLCD << std::endl;
+			return status;
+		}
+	}
+
+	status |= LCDClearLine(LCDLineNumberOne);
+	
+	if (_NumRowsLCD >= 2)
+		status |= LCDClearLine(LCDLineNumberTwo);
+	if (_NumRowsLCD >= 3)
+		status |= LCDClearLine(LCDLineNumberThree);
+	if (_NumRowsLCD == 4)
+		status |= LCDClearLine(LCDLineNumberFour);
+	return status;
+}
+
+
+/*!
+	@brief  Reset screen
+	@param CursorType LCDCursorType_e enum cursor type, 4 choices
+	@return LCDStatus_e, bits of all the transfers
+*/
+uint8_t HD44780PCF8574LCD::LCDResetScreen(LCDCursorType_e CursorType) {
+	uint8_t status = LCDSendCmd(LCDCmdModeFourBit);
+	status |= LCDSendCmd(LCDCmdDisplayOn);
+	status |= LCDSendCmd(CursorType);
+	status |= LCDSendCmd(LCDCmdClearScreen);
+	LCDWaitReady(5, LCDExecTimeLongUs);
+	status |= LCDSendCmd(LCDEntryModeThree);
+	if (_ShadowON == true) LCDShadowFill(0xFF);
+	return status;
+}
+
+/*!
+	@brief  Turn Screen on and off
+	@param OnOff  True = display on , false = display off
+	@return LCDStatus_e
+*/
+uint8_t HD44780PCF8574LCD::LCDDisplayON(bool OnOff) {
+	uint8_t status = OnOff ? LCDSendCmd(LCDCmdDisplayOn) : LCDSendCmd(LCDCmdDisplayOff);
+	LCDWaitReady(5, LCDExecTimeUs);
+	return status;
+}
+
+
+/*!
+	@brief  Change the cursor type, screen contents kept
+	@param CursorType LCDCursorType_e enum cursor type, 4 choices, also switches the display on
+	@return LCDStatus_e
+	@note Also sends a change made by LCDBackLightSet.
+*/
+uint8_t HD44780PCF8574LCD::LCDCursorTypeSet(LCDCursorType_e CursorType) {
+	uint8_t status = LCDSendCmd(CursorType);
+	LCDWaitReady(5, LCDExecTimeUs);
+	return status;
+}
+
+/*!
+	@brief  Initialise LCD
+	@param CursorType  The cursor type 4 choices.
+	@note The busy flag can not be read until the interface is in 4-bit mode,
+		so the waits before function set are always timed.
+	@return LCDStatus_e, bits of all the transfers
+*/
+uint8_t HD44780PCF8574LCD::LCDInit(LCDCursorType_e CursorType) {
+
+	_Transport->DelayMs(15); // power on
+	uint8_t status = LCDResync();
+	status |= LCDSendCmd(LCDCmdDisplayOn);
+	status |= LCDSendCmd(CursorType);
+	status |= LCDSendCmd(LCDEntryModeThree);
+	status |= LCDSendCmd(LCDCmdClearScreen);
+	LCDWaitReady(5, LCDExecTimeLongUs);
+	if (_ShadowON == true) LCDShadowFill(0xFF);
+	return status;
+}
+
+/*!
+	@brief  Bring the interface into 4-bit mode from any state, 2 line mode
+	@return LCDStatus_e, bits of all the transfers
+	@details Datasheet initialization by instruction, three single 0x3 nibbles(function set
+		8-bit) then a single 0x2 nibble(function set 4-bit), then function set 2 lines and
+		the tracked display control and entry mode. Finishes with home.
+	@note Works from 8-bit mode after power on, 4-bit mode, or 4-bit mode half way 
+		through a byte, where the first nibble completes the byte as x3(home, cursor shift,
+		function set or an address, never a clear). DDRAM and CGRAM are left alone, 
+		display shift is undone. The busy flag can not be read until the interface is 
+		in 4-bit mode, so the waits before function set are always timed.
+*/
+uint8_t HD44780PCF8574LCD::LCDResync(void) {
+	uint8_t status = LCDSendNibble(0x30);
+	LCDWaitReady(5, LCDExecTimeInitUs, false);
+	status |= LCDSendNibble(0x30);
+	LCDWaitReady(1, LCDExecTimeResyncUs, false);
+	status |= LCDSendNibble(0x30);
+	LCDWaitReady(1, LCDExecTimeResyncUs, false);
+	status |= LCDSendNibble(0x20);
+	LCDWaitReady(1, LCDExecTimeUs, false);
+	LCDBatchCmd(LCDCmdModeFourBit);
+	LCDBatchCmd(_DisplayControl);
+	LCDBatchCmd(_EntryMode);
+	LCDBatchCmd(LCDCmdHomePosition); // address counter was lost
+	status |= LCDBatchSend();
+	LCDWaitReady(5, LCDExecTimeLongUs);
+	return status;
+}
+
+/*!
+	@brief  Send one command nibble on its own, for LCDResync
+	@param nibble command nibble in the upper four bits
+	@return LCDStatus_e
+	@details Enable high then low, the first two frames of a command byte. Sent at once,
+		in 8-bit mode each nibble is a whole instruction and needs its wait.
+*/
+uint8_t HD44780PCF8574LCD::LCDSendNibble(uint8_t nibble) {
+	if (_BatchLen + 2U > sizeof(_BatchBufferI2C)) _BatchError = LCDBatchSend();
+	_BatchStartCmd = 0; // no set address ahead of a retransmit, the interface may be in 8-bit mode
+
+	const HD44780FrameTable &table = HD44780FrameTables[0][_LCDBackLight == LCDBackLightOnMask];
+	memcpy(&_BatchBufferI2C[_BatchLen], table.Frames[nibble & 0xF0], 2);
+	_BatchLen += 2;
+	_Stats.Commands++;
+	return LCDBatchSend();
+}
+
+/*!
+	@brief  Take over a display that may already be running, without clearing it
+	@param snapshotPath file written by LCDSnapshotSave before the restart
+	@param CursorType cursor type for LCDInit if there is no usable snapshot
+	@return LCDAttach_e, how the display was taken over, transfer errors in LCDI2CErrorGet
+	@details Turns shadow mode on with the snapshot contents. If the controller answers 
+		in 4-bit mode (needs RW wired) nothing is reset, the snapshot is taken as what is
+		on the glass and the next flush() sends only the cells drawn differently. 
+		Otherwise the interface is resynchronised without a clear, CGRAM is reloaded 
+		and the next flush() writes every cell over the old contents, no blank screen.
+		Display control, entry mode and backlight come from the snapshot.
+		Falls back to LCDInit if the file is missing, or from another display size,
+		or the display is too big for shadow mode.
+		Assumes the display has had power for more than 15mS.
+*/
+HD44780PCF8574LCD::LCDAttach_e HD44780PCF8574LCD::LCDAttach(const std::string &snapshotPath, LCDCursorType_e CursorType) {
+	uint16_t size = _NumRowsLCD * _NumColsLCD;
+	if (size > LCD_DDRAM_SIZE) // no shadow mode
+	{
+		LCDInit(CursorType);
+		return LCDAttachInit;
+	}
+	std::ifstream file(snapshotPath, std::ios::binary);
+	uint8_t header[14] = {0};
+	uint8_t cells[LCD_DDRAM_SIZE];
+	uint8_t cgram[sizeof(_CGRAMMirror)];
+	file.read(reinterpret_cast<char *>(header), sizeof(header));
+	file.read(reinterpret_cast<char *>(cells), size);
+	file.read(reinterpret_cast<char *>(cgram), sizeof(cgram));
+	if (!file || memcmp(header, "HD4W", 4) != 0 || header[4] != LCD_SNAPSHOT_VERSION
+		|| header[5] != _NumRowsLCD || header[6] != _NumColsLCD)
+	{
+		LCDInit(CursorType);
+		return LCDAttachInit;
+	}
+	uint8_t displayControl = header[7], entryMode = header[8], displayShift = header[10];
+	uint8_t cursorAddress = header[11];
+	bool cellsValid = header[12];
+	LCDBackLightSet(header[9]);
+
+	uint8_t status = 0xFF;
+	bool warm = LCDAttachProbe(status);
+	if (warm == false)
+	{
+		LCDResync();
+		_CGRAMKnown = 0;
+	}
+	LCDBatchCmd(0x08 | (displayControl & 0x07));
+	LCDBatchCmd(0x04 | (entryMode & 0x03));
+	for (uint8_t slot = 0; slot < LCD_CGRAM_SLOTS; slot++)
+	{
+		_GlyphSlotOwner[slot] = LCD_GLYPH_NONE;
+		if ((header[13] & (1 << slot)) == 0) continue;
+		memcpy(&_CGRAMMirror[slot * 8], &cgram[slot * 8], 8);
+		_CGRAMKnown |= (1 << slot);
+		if (warm == true) continue; // still in CGRAM
+		LCDBatchCmd(0x40 | (slot << 3));
+		LCDBatchDataRun(&cgram[slot * 8], 8);
+	}
+	if (warm == true)
+	{
+		_DisplayShift = displayShift % LCD_DDRAM_LINE; // the probe moved the address counter only
+		if (cursorAddress != HD44780AddressNone) LCDBatchAddress(0x80 | cursorAddress);
+	}
+	LCDBatchSend();
+
+	_ShadowON = true;
+	memcpy(_ShadowBuffer, cells, size);
+	memcpy(_ShadowGlass, cells, size);
+	_ShadowGlassValid = (warm == true && cellsValid == true);
+	_ShadowRow = 0;
+	_ShadowCol = 0;
+	return warm ? LCDAttachWarm : LCDAttachResync;
+}
+
+/*!
+	@brief  Check if the controller is in 4-bit mode and in step, by setting the 
+		address counter and reading it back
+	@param status set to BF + AC6-0 read back, 0xFF with RW not wired, BF set on a transfer error
+	@return true if the address read back matches
+	@details The probe address has different nibbles, a controller still in 8-bit 
+		mode, or a nibble out of step, takes them as other commands and reads back 
+		something else.
+*/
+bool HD44780PCF8574LCD::LCDAttachProbe(uint8_t &status) {
+	const uint8_t probe = 0x27; // last column of line 1, nibbles 2 and 7
+	status = 0x80;
+	LCDBatchCmd(0x80 | probe);
+	if (LCDBatchSend() != 0) return false;
+	_Transport->DelayUs(LCDExecTimeUs);
+	if (LCDReadStatus(status) == false) 
+	{
+		status = 0x80;
+		return false;
+	}
+	return status == probe;
+}
+
+/*!
+	@brief  Save what is on the display, for LCDAttach after a restart
+	@param snapshotPath file to write, replaced atomically
+	@return false if the file can not be written, or the display is too big for shadow mode
+	@details Saves the cells as of the last flush(shadow mode only, otherwise marked
+		unknown), custom characters, cursor type, entry mode, display shift and backlight.
+		About 160 bytes, cheap enough to call after every flush.
+*/
+bool HD44780PCF8574LCD::LCDSnapshotSave(const std::string &snapshotPath) {
+	uint16_t size = _NumRowsLCD * _NumColsLCD;
+	if (size > LCD_DDRAM_SIZE) return false;
+	const uint8_t header[14] = {'H', 'D', '4', 'W', LCD_SNAPSHOT_VERSION, _NumRowsLCD, _NumColsLCD,
+		_DisplayControl, _EntryMode, LCDBackLightGet(), _DisplayShift,
+		static_cast<uint8_t>(_CursorKnown ? _CursorAddress : HD44780AddressNone),
+		(_ShadowON == true && _ShadowGlassValid == true), _CGRAMKnown};
+	std::string temp = snapshotPath + ".tmp";
+	std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char *>(header), sizeof(header));
+	file.write(reinterpret_cast<const char *>(_ShadowGlass), size);
+	file.write(reinterpret_cast<const char *>(_CGRAMMirror), sizeof(_CGRAMMirror));
+	file.close();
+	if (!file) return false;
+	return std::rename(temp.c_str(), snapshotPath.c_str()) == 0;
+}
+
+/*!
+	@brief  Send a string to LCD
+	@param str  Pointer to the char array
+	@return LCDStatus_e
+*/
+uint8_t HD44780PCF8574LCD::LCDSendString(char *str) {
+	if (_Charset != LCDCharsetRaw) return LCDSendText(reinterpret_cast<uint8_t *>(str), strlen(str));
+	if (_ShadowON == true)
+	{
+		while (*str) LCDShadowWrite(*str++);
+		return LCDStatusOK;
+	}
+	LCDBatchDataRun(reinterpret_cast<uint8_t *>(str), strlen(str));
+	return LCDBatchSend();
+}
+
+
+/*!
+	@brief  Sends a character to screen , simply wraps SendData command.
+	@param data Character to display
+	@return LCDStatus_e
+*/
+uint8_t HD44780PCF8574LCD::LCDSendChar(char data) {
+	if (_Charset != LCDCharsetRaw) return LCDSendText(reinterpret_cast<uint8_t *>(&data), 1);
+	if (_ShadowON == true)
+	{
+		LCDShadowWrite(data);
+		return LCDStatusOK;
+	}
+	return LCDSendData(data);
+}
+
+/*!
+	@brief  Set how text is turned into character codes
+	@param charset LCDCharsetRaw(default) or LCDCharsetA00/LCDCharsetA02 to match the ROM of the LCD,
+		the ROM code is on the controller chip e.g. HD44780UA00
+	@param replacement character code shown for text the ROM can not show
+	@details With A00 or A02, LCDSendString LCDSendChar and print decode their text as UTF-8.
+		Each code point is looked up in the ROM table, then in the glyph registry with the
+		code point as glyph ID(LCDGlyphRegister(0x2191, arrowUp) for ↑), else replacement.
+		LCDPrintCustomChar is not affected.
+*/
+void HD44780PCF8574LCD::LCDCharsetSet(LCDCharset_e charset, uint8_t replacement)
+{
+	_Charset = charset;
+	_CharsetReplacement = replacement;
+	_UTF8Decoder.Reset();
+}
+
+/*!
+	@brief  Get how text is turned into character codes
+	@return LCDCharset_e
+*/
+HD44780PCF8574LCD::LCDCharset_e HD44780PCF8574LCD::LCDCharsetGet(void) { return _Charset;}
+
+/*!
+	@brief  Decode UTF-8 text, map it to character codes and send it in one batch
+	@param text UTF-8 bytes, a sequence may carry on in the next call
+	@param length number of bytes
+	@return LCDStatus_e
+	@note One pass, no allocation. A glyph not yet in CGRAM is uploaded inline,
+		which ends the transaction early.
+*/
+uint8_t HD44780PCF8574LCD::LCDSendText(const uint8_t *text, size_t length)
+{
+	size_t i = 0;
+	while (i < length)
+	{
+		uint32_t codePoint;
+		bool consumed;
+		bool complete = _UTF8Decoder.Step(text[i], codePoint, consumed);
+		if (consumed == true) i++;
+		if (complete == false) continue;
+		uint8_t code = LCDCharsetCode(codePoint);
+		(_ShadowON == true) ? LCDShadowWrite(code) : LCDBatchData(code);
+	}
+	if (_ShadowON == true) return LCDStatusOK;
+	return LCDBatchSend();
+}
+
+/*!
+	@brief  Character code for a code point, ROM then glyph registry then replacement
+	@param codePoint Unicode code point
+	@return character code
+*/
+uint8_t HD44780PCF8574LCD::LCDCharsetCode(uint32_t codePoint)
+{
+	uint8_t code;
+	if (HD44780CharsetLookup(_Charset == LCDCharsetA02, codePoint, code) == true) return code;
+	if (codePoint < LCD_GLYPH_NONE && LCDGlyphIndexOf(codePoint) >= 0)
+	{
+		int8_t slot = LCDGlyphLoad(codePoint);
+		if (slot >= 0) return slot;
+	}
+	return _CharsetReplacement;
+}
+
+
+/*!
+	@brief  Moves cursor
+	@param direction enum LCDDirectionType_e left or right
+	@param moveSize number of spaces to move
+	@return LCDStatus_e
+	@details The cursor walks the 80 DDRAM positions in a ring, 0x27 is followed by 0x40.
+		If the address counter is tracked the move is one set DDRAM address command(or none),
+		else the cursor shift commands are sent the shorter way round, in one transfer.
+		In shadow mode the cursor stays on its row, a move left stops at column 0.
+*/
+uint8_t HD44780PCF8574LCD::LCDMoveCursor(LCDDirectionType_e direction, uint8_t moveSize) {
+	const uint8_t LCDMoveCursorLeft = 0x10;  //Command Byte Code:  Move cursor one character left 
+	const uint8_t LCDMoveCursorRight = 0x14;  // Command Byte Code : Move cursor one character right 
+	if (_ShadowON == true)
+	{
+		if (direction == LCDMoveRight)
+			_ShadowCol = (moveSize > 0xFF - _ShadowCol) ? 0xFF : _ShadowCol + moveSize; // off screen, no wrap back
+		else
+			_ShadowCol = (moveSize > _ShadowCol) ? 0 : _ShadowCol - moveSize;
+		return LCDStatusOK;
+	}
+
+	uint8_t steps = moveSize % LCD_DDRAM_SIZE;
+	if (steps == 0) return LCDStatusOK;
+	if (_CursorKnown == true)
+	{
+		uint8_t address = _CursorAddress;
+		while (steps--) address = LCDAddressStep(address, direction == LCDMoveRight);
+		LCDBatchAddress(0x80 | address);
+		return LCDBatchSend();
+	}
+	bool right = (direction == LCDMoveRight);
+	if (steps > LCD_DDRAM_SIZE / 2)
+	{
+		steps = LCD_DDRAM_SIZE - steps;
+		right = !right;
+	}
+	while (steps--) LCDBatchCmd(right ? LCDMoveCursorRight : LCDMoveCursorLeft);
+	return LCDBatchSend();
+}
 
-	for (uint8_t i = 0; i < _NumColsLCD; i++) {
-		LCDSendData(' ');
+/*!
+	@brief  Scrolls screen
+	@param direction  left or right
+	@param ScrollSize number of spaces to scroll
+	@return LCDStatus_e
+	@details Each line is a 40 character ring, so the scroll is reduced modulo 40 and 
+		the shift commands are sent the shorter way round, in one transfer.
+*/
+uint8_t HD44780PCF8574LCD::LCDScroll(LCDDirectionType_e direction, uint8_t ScrollSize) {
+	uint8_t steps = ScrollSize % LCD_DDRAM_LINE;
+	if (steps == 0) return LCDStatusOK;
+	bool right = (direction == LCDMoveRight);
+	if (steps > LCD_DDRAM_LINE / 2)
+	{
+		steps = LCD_DDRAM_LINE - steps;
+		right = !right;
 	}
+	while (steps--) LCDBatchCmd(right ? LCDCmdScrollRight : LCDCmdScrollLeft);
+	return LCDBatchSend();
+}
+
+/*!
+	@brief  Start a marquee, a message scrolling right to left along one line
+	@param line row 1 or 2 of a 1 or 2 row display
+	@param text message, bytes sent as is, copied
+	@param stepMs time between one column steps, 0 = one step per LCDMarqueeTick call
+	@param gap spaces between the end of the message and its next pass
+	@return false if a 4 row or 16x1 display, bad line, empty text or a transfer failed
+	@details The first 40 columns of the loop are written into the 40 byte DDRAM line
+		once, each step is then one display shift command. Characters beyond those 40
+		are streamed into the off screen columns, a batch at a time, only when they are
+		about to scroll into view. A loop(message + gap) of 40 or less is never rewritten.
+	@note The HD44780 display shift moves every line, the other row scrolls too.
+		Sends LCDHome to start from no shift. Assumes entry mode three(increment).
+*/
+bool HD44780PCF8574LCD::LCDMarqueeBegin(LCDLineNumber_e line, const std::string &text, uint16_t stepMs, uint8_t gap)
+{
+	if (_NumRowsLCD > 2 || _Geometry.SplitColumn != 0) return false; // rows share or split a DDRAM line
+	if (line < LCDLineNumberOne || line > _NumRowsLCD || text.empty()) return false;
+
+	_MarqueeText = text;
+	_MarqueeRowAddress = _Geometry.RowAddress[line - 1];
+	_MarqueePeriod = text.size() + gap;
+	if (_MarqueePeriod <= LCD_DDRAM_LINE) _MarqueePeriod = LCD_DDRAM_LINE; // pad, whole loop fits in DDRAM
+	_MarqueeStepMs = stepMs;
+	_MarqueeStep = 0;
+	_MarqueeLoaded = 0;
+	_MarqueeON = true;
+
+	uint8_t status = LCDHome();
+	LCDMarqueeLoad(LCD_DDRAM_LINE);
+	status |= LCDBatchSend();
+	_MarqueeNext = std::chrono::steady_clock::now() + std::chrono::milliseconds(_MarqueeStepMs);
+	return (status == LCDStatusOK);
+}
+
+/*!
+	@brief  Advance the marquee if a step is due, call often from the main loop
+	@return true if the display was shifted
+	@details Never waits. Steps missed since the last call are caught up in the same
+		transfer, up to one lap. In async mode the transfer is only queued.
+*/
+bool HD44780PCF8574LCD::LCDMarqueeTick(void)
+{
+	if (_MarqueeON == false) return false;
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (now < _MarqueeNext) return false;
+
+	uint8_t steps = 0;
+	do
+	{
+		if (_MarqueeLoaded <= _MarqueeStep + _NumColsLCD) // next column to show not yet in DDRAM
+			LCDMarqueeLoad(_MarqueeStep + LCD_DDRAM_LINE); // every off screen column
+		LCDBatchCmd(LCDCmdScrollLeft);
+		_MarqueeStep++;
+		_MarqueeNext += std::chrono::milliseconds(_MarqueeStepMs);
+	} while (_MarqueeStepMs > 0 && now >= _MarqueeNext && ++steps < LCD_DDRAM_LINE);
+	if (now >= _MarqueeNext) _MarqueeNext = now + std::chrono::milliseconds(_MarqueeStepMs); // too far behind
+	LCDBatchSend();
+	return true;
+}
+
+/*!
+	@brief  Stop the marquee and undo the display shift with LCDHome
+	@note The marquee text stays in DDRAM.
+*/
+void HD44780PCF8574LCD::LCDMarqueeEnd(void)
+{
+	if (_MarqueeON == false) return;
+	_MarqueeON = false;
+	LCDHome();
+}
+
+/*!
+	@brief  Check if a marquee is running
+	@return true if running
+*/
+bool HD44780PCF8574LCD::LCDMarqueeGet(void) { return _MarqueeON;}
+
+/*!
+	@brief  Start drawing the next page in the off screen DDRAM columns
+	@return false if the display has no room for a second page, or shadow mode or a marquee is on
+	@details Each 40 character DDRAM line holds two pages, page 0 in columns 0 to cols-1 and 
+		page 1 in the last cols columns. Until LCDPageShow, LCDGOTO, print, LCDClearLine etc.
+		draw on the page not in view. The page keeps what was drawn on it two flips ago, 
+		LCDClearScreen() while drawing blanks it. 1 and 2 row displays up to 20 columns, 
+		rows 3 and 4 use the off screen columns. Display shift and LCDScroll move the pages.
+*/
+bool HD44780PCF8574LCD::LCDPageBegin(void)
+{
+	if (_NumRowsLCD > 2 || _NumColsLCD > LCD_DDRAM_LINE / 2 || _Geometry.SplitColumn != 0) return false;
+	if (_ShadowON == true || _MarqueeON == true) return false;
+	if (_PageComposing == false)
+	{
+		_PageOffset = (_PageOffset == 0) ? LCD_DDRAM_LINE - _NumColsLCD : 0;
+		_PageComposing = true;
+	}
+	return true;
+}
+
+/*!
+	@brief  Bring the page drawn since LCDPageBegin into view
+	@return LCDStatus_e
+	@details Page 0 is one return home command, page 1 is one display shift per column, 
+		16 or 20 commands in a single I2C transaction. Either is fewer bus bytes than
+		rewriting the screen, and no cell is ever seen half drawn. Drawing then carries
+		on on the page in view.
+*/
+uint8_t HD44780PCF8574LCD::LCDPageShow(void)
+{
+	if (_PageComposing == false) return LCDStatusOK;
+	_PageComposing = false;
+	if (_PageOffset == 0) return LCDHome(); // also undoes the display shift
+
+	uint8_t left = (_PageOffset + LCD_DDRAM_LINE - _DisplayShift) % LCD_DDRAM_LINE; // left shifts needed
+	bool toLeft = (left <= LCD_DDRAM_LINE / 2);
+	for (uint8_t count = toLeft ? left : LCD_DDRAM_LINE - left; count > 0; count--)
+		LCDBatchCmd(toLeft ? LCDCmdScrollLeft : LCDCmdScrollRight);
+	return LCDBatchSend();
+}
+
+/*!
+	@brief  Get the page in view
+	@return 0 or 1
+*/
+uint8_t HD44780PCF8574LCD::LCDPageVisibleGet(void)
+{
+	uint8_t drawn = (_PageOffset == 0) ? 0 : 1;
+	return _PageComposing ? 1 - drawn : drawn;
 }
 
 /*!
-	@brief  Clear screen by writing spaces to every position
-	@note : See also LCDClearScreenCmd for software command clear alternative.
+	@brief  Queue the marquee loop positions from _MarqueeLoaded up to end
+	@param end first loop position not to write
+	@details Loop position p is shown when the display has been shifted p columns or
+		less and lives at line offset p mod 40, a run is split where the offset wraps.
 */
-void HD44780PCF8574LCD::LCDClearScreen(void) {
-	if (_NumRowsLCD < 1 || _NumRowsLCD >4)
+void HD44780PCF8574LCD::LCDMarqueeLoad(uint32_t end)
+{
+	if (_MarqueePeriod == LCD_DDRAM_LINE && _MarqueeLoaded >= LCD_DDRAM_LINE) return; // loop already in DDRAM
+	while (_MarqueeLoaded < end)
 	{
-		if (_DebugON == true)
+		LCDBatchAddress(0x80 | (_MarqueeRowAddress + _MarqueeLoaded % LCD_DDRAM_LINE));
+		do
 		{
-			std::cout << "Error 603 : Number of rows invalid, must be:" << _NumRowsLCD << std::endl;
-			return;
-		}
+			uint32_t index = _MarqueeLoaded % _MarqueePeriod;
+			LCDBatchData(index < _MarqueeText.size() ? _MarqueeText[index] : ' ');
+			_MarqueeLoaded++;
+		} while (_MarqueeLoaded < end && _MarqueeLoaded % LCD_DDRAM_LINE != 0);
 	}
-
-	LCDClearLine(LCDLineNumberOne);
-	
-	if (_NumRowsLCD >= 2)
-		LCDClearLine(LCDLineNumberTwo);
-	if (_NumRowsLCD >= 3)
-		LCDClearLine(LCDLineNumberThree);
-	if (_NumRowsLCD == 4)
-		LCDClearLine(LCDLineNumberFour);
 }
 
+/*!
+	@brief  moves cursor to an x , y position on display.
+	@param  line  x row 1-4
+	@param col y column  0-15 or 0-19
+	@note Nothing is sent if the tracked address counter is already at that position,
+		e.g. after writing the text just before it in entry mode three.
+	@return LCDStatus_e
+*/
+uint8_t HD44780PCF8574LCD::LCDGOTO(LCDLineNumber_e line, uint8_t col) {
+	uint8_t row = line - 1;
+	return LCDGOTOAddress(row, col, (row < _NumRowsLCD) ? HD44780CellAddress(_Geometry, row, col) : HD44780AddressNone);
+}
 
 /*!
-	@brief  Reset screen
-	@param CursorType LCDCursorType_e enum cursor type, 4 choices
+	@brief  Move the cursor to a cell whose DDRAM address is already known
+	@param  row row 0-3
+	@param  col column
+	@param  address DDRAM address of the cell, HD44780AddressNone = row does not exist, nothing sent
+	@return LCDStatus_e
+	@note Shared by LCDGOTO and the compile time sized HD44780LCD::LCDGOTO
 */
-void HD44780PCF8574LCD::LCDResetScreen(LCDCursorType_e CursorType) {
-	LCDSendCmd(LCDCmdModeFourBit);
-	LCDSendCmd(LCDCmdDisplayOn);
-	LCDSendCmd(CursorType);
-	LCDSendCmd(LCDCmdClearScreen);
-	LCDSendCmd(LCDEntryModeThree);
-	bcm2835_delay(5);
+uint8_t HD44780PCF8574LCD::LCDGOTOAddress(uint8_t row, uint8_t col, uint8_t address) {
+	if (_ShadowON == true)
+	{
+		_ShadowRow = row;
+		_ShadowCol = col;
+		return LCDStatusOK;
+	}
+	if (address == HD44780AddressNone) return LCDStatusOK;
+	LCDBatchAddress(0x80 | LCDPageAddress(address));
+	return LCDBatchSend();
 }
 
 /*!
-	@brief  Turn Screen on and off
-	@param OnOff  True = display on , false = display off
+	@brief  Get the DDRAM address of a cell from the row address table
+	@param  row row 0-3
+	@param  col column
+	@return DDRAM address, HD44780AddressNone if the display has no such row
+	@note On the page being drawn, see LCDPageBegin
 */
-void HD44780PCF8574LCD::LCDDisplayON(bool OnOff) {
-	OnOff ? LCDSendCmd(LCDCmdDisplayOn) : LCDSendCmd(LCDCmdDisplayOff);
-	bcm2835_delay(5);
+uint8_t HD44780PCF8574LCD::LCDCellAddress(uint8_t row, uint8_t col) {
+	if (row >= 4 || _Geometry.RowAddress[row] == HD44780AddressNone) return HD44780AddressNone;
+	return LCDPageAddress(HD44780CellAddress(_Geometry, row, col));
 }
 
+/*!
+	@brief  Move a page 0 DDRAM address onto the page being drawn
+	@param  address DDRAM address of a cell of page 0
+	@return DDRAM address on the same line, _PageOffset columns on
+*/
+uint8_t HD44780PCF8574LCD::LCDPageAddress(uint8_t address) {
+	if (_PageOffset == 0) return address;
+	return (address & 0x40) | (((address & 0x3F) + _PageOffset) % LCD_DDRAM_LINE);
+}
 
 /*!
-	@brief  Initialise LCD
-	@param CursorType  The cursor type 4 choices.
+	@brief  Saves a custom character to a location in character generator RAM 64 bytes.
+	@param location CG_RAM location 0-7, we only have 8 locations 64 bytes
+	@param charmap An array of 8 bytes representing a custom character data
+	@return LCDStatus_e
+	@note The location is reserved, the glyph registry never loads into it, 
+		until LCDReleaseCustomChar.
 */
-void HD44780PCF8574LCD::LCDInit(LCDCursorType_e CursorType) {
+uint8_t HD44780PCF8574LCD::LCDCreateCustomChar(uint8_t location, uint8_t * charmap)
+{
 
-	bcm2835_delay(15);
-	LCDSendCmd(LCDCmdHomePosition);
-	bcm2835_delay(5);
-	LCDSendCmd(LCDCmdHomePosition);
-	bcm2835_delay(5);
-	LCDSendCmd(LCDCmdHomePosition);
-	bcm2835_delay(5);
-	LCDSendCmd(LCDCmdModeFourBit);
-	LCDSendCmd(LCDCmdDisplayOn);
-	LCDSendCmd(CursorType);
-	LCDSendCmd(LCDEntryModeThree);
-	LCDSendCmd(LCDCmdClearScreen);
-	bcm2835_delay(5);
+	const uint8_t LCD_CG_RAM = 0x40;  //  character-generator RAM (CG RAM address) 
+	 if (location >= 8) {return LCDStatusOK;}
+	 
+	LCDBatchCmd(LCD_CG_RAM | (location<<3));
+	for (uint8_t i=0; i<8; i++) {
+		LCDBatchData(charmap[i]);
+	}
+	_GlyphSlotOwner[location] = LCD_GLYPH_PINNED;
+	memcpy(&_CGRAMMirror[location * 8], charmap, 8);
+	_CGRAMKnown |= (1 << location);
+	return LCDBatchSend();
 }
 
 /*!
-	@brief  Send a string to LCD
-	@param str  Pointer to the char array
+	@brief  Give a CGRAM location written by LCDCreateCustomChar back to the glyph registry
+	@param location CG_RAM location 0-7
 */
-void HD44780PCF8574LCD::LCDSendString(char *str) {
-	while (*str) LCDSendData(*str++);
+void HD44780PCF8574LCD::LCDReleaseCustomChar(uint8_t location)
+{
+	if (location >= LCD_CGRAM_SLOTS || _GlyphSlotOwner[location] != LCD_GLYPH_PINNED) return;
+	_GlyphSlotOwner[location] = LCD_GLYPH_NONE;
+	_GlyphSlotUsed[location] = 0;
 }
 
-
 /*!
-	@brief  Sends a character to screen , simply wraps SendData command.
-	@param data Character to display
+	@brief  Add a glyph to the registry, or change its bitmap
+	@param glyphID caller chosen stable ID, any value except 0xFFFE and 0xFFFF
+	@param charmap An array of 8 bytes representing a custom character data, copied
+	@return false if registry full(LCD_GLYPH_MAX) or invalid ID
+	@details Registered glyphs are mapped onto the 8 CGRAM slots on demand 
+		by LCDGlyphLoad / LCDPrintGlyph, least recently used slot evicted.
 */
-void HD44780PCF8574LCD::LCDSendChar(char data) {
-	LCDSendData(data);
+bool HD44780PCF8574LCD::LCDGlyphRegister(uint16_t glyphID, const uint8_t *charmap)
+{
+	if (glyphID == LCD_GLYPH_NONE || glyphID == LCD_GLYPH_PINNED) return false;
+	int8_t index = LCDGlyphIndexOf(glyphID);
+	if (index < 0)
+	{
+		if (_GlyphCount >= LCD_GLYPH_MAX) return false;
+		index = _GlyphCount++;
+		_GlyphID[index] = glyphID;
+	}
+	else if (memcmp(_GlyphBitmap[index], charmap, 8) != 0)
+	{
+		for (uint8_t slot = 0; slot < LCD_CGRAM_SLOTS; slot++) // resident copy is stale
+			if (_GlyphSlotOwner[slot] == glyphID) _GlyphSlotOwner[slot] = LCD_GLYPH_NONE;
+	}
+	memcpy(_GlyphBitmap[index], charmap, 8);
+	return true;
 }
 
-
 /*!
-	@brief  Moves cursor
-	@param direction enum LCDDirectionType_e left or right
-	@param moveSize number of spaces to move
+	@brief  Make a registered glyph resident in CGRAM
+	@param glyphID ID passed to LCDGlyphRegister
+	@return CGRAM slot 0-7 holding the glyph, -1 if ID unknown or upload failed
+	@details A hit costs nothing on the bus. A miss uploads 8 bytes to a free slot,
+		else the least recently used slot not on screen(shadow mode), else the least 
+		recently used slot. Slots of LCDCreateCustomChar are never used, -1 if that is all 8.
+		The DDRAM address is restored after the upload if known.
 */
-void HD44780PCF8574LCD::LCDMoveCursor(LCDDirectionType_e direction, uint8_t moveSize) {
-	uint8_t i = 0;
-	const uint8_t LCDMoveCursorLeft = 0x10;  //Command Byte Code:  Move cursor one character left 
-	const uint8_t LCDMoveCursorRight = 0x14;  // Command Byte Code : Move cursor one character right 
-	switch(direction)
+int8_t HD44780PCF8574LCD::LCDGlyphLoad(uint16_t glyphID)
+{
+	const uint8_t LCD_CG_RAM = 0x40;  //  character-generator RAM (CG RAM address) 
+	int8_t index = LCDGlyphIndexOf(glyphID);
+	if (index < 0) return -1;
+
+	_GlyphTick++;
+	for (uint8_t slot = 0; slot < LCD_CGRAM_SLOTS; slot++)
 	{
-	case LCDMoveRight:
-		for (i = 0; i < moveSize; i++) {
-			LCDSendCmd(LCDMoveCursorRight);
-		}
-	break;
-	case LCDMoveLeft:
-		for (i = 0; i < moveSize; i++) {
-			LCDSendCmd(LCDMoveCursorLeft);
-		}
-	break;
+		if (_GlyphSlotOwner[slot] != glyphID) continue;
+		_GlyphSlotUsed[slot] = _GlyphTick;
+		_GlyphHits++;
+		return slot;
+	}
+
+	_GlyphMisses++;
+	int8_t slot = LCDGlyphVictim();
+	if (slot < 0) return -1;
+	bool restore = _CursorKnown;
+	uint8_t address = _CursorAddress;
+	LCDBatchCmd(LCD_CG_RAM | (slot << 3));
+	LCDBatchDataRun(_GlyphBitmap[index], 8);
+	if (restore == true) LCDBatchAddress(0x80 | address);
+	if (LCDBatchSend() != 0)
+	{
+		_GlyphSlotOwner[slot] = LCD_GLYPH_NONE;
+		return -1;
 	}
+	_GlyphSlotOwner[slot] = glyphID;
+	_GlyphSlotUsed[slot] = _GlyphTick;
+	memcpy(&_CGRAMMirror[slot * 8], _GlyphBitmap[index], 8);
+	_CGRAMKnown |= (1 << slot);
+	return slot;
 }
 
 /*!
-	@brief  Scrolls screen
-	@param direction  left or right
-	@param ScrollSize number of spaces to scroll
+	@brief  Print a registered glyph, loading it into CGRAM if needed
+	@param glyphID ID passed to LCDGlyphRegister
+	@return false if ID unknown or a transfer failed
 */
-void HD44780PCF8574LCD::LCDScroll(LCDDirectionType_e direction, uint8_t ScrollSize) {
-	uint8_t i = 0;
+bool HD44780PCF8574LCD::LCDPrintGlyph(uint16_t glyphID)
+{
+	int8_t slot = LCDGlyphLoad(glyphID);
+	if (slot < 0) return false;
+	return (LCDPrintCustomChar(slot) == LCDStatusOK);
+}
 
-	const uint8_t LCDScrollRight = 0x1E;  // Command Byte Code: Scroll display one character right (all lines) 
-	const uint8_t LCDScrollLeft = 0x18;  //Command Byte Code: Scroll display one character left (all lines) 
-	
-	switch(direction)
+/*!
+	@brief  Forget which glyphs are resident, next load of each uploads again
+	@note Call after the LCD has lost power. The registry and the locations 
+		reserved by LCDCreateCustomChar are kept.
+*/
+void HD44780PCF8574LCD::LCDGlyphInvalidate(void)
+{
+	for (uint8_t slot = 0; slot < LCD_CGRAM_SLOTS; slot++)
 	{
-	case LCDMoveRight:
-		for (i = 0; i < ScrollSize; i++) {
-			LCDSendCmd(LCDScrollRight);
-		}
-	break;
-	case LCDMoveLeft:
-		for (i = 0; i < ScrollSize; i++) {
-			LCDSendCmd(LCDScrollLeft);
-		}
-	break;
+		if (_GlyphSlotOwner[slot] == LCD_GLYPH_PINNED) continue;
+		_GlyphSlotOwner[slot] = LCD_GLYPH_NONE;
+		_GlyphSlotUsed[slot] = 0;
 	}
 }
 
 /*!
-	@brief  moves cursor to an x , y position on display.
-	@param  line  x row 1-4
-	@param col y column  0-15 or 0-19
+	@brief  Get the number of glyph loads that found the glyph already in CGRAM
+	@return hit count
 */
-void HD44780PCF8574LCD::LCDGOTO(LCDLineNumber_e line, uint8_t col) {
+uint32_t HD44780PCF8574LCD::LCDGlyphHitsGet(void) { return _GlyphHits;}
 
-	switch (line) {
-		case LCDLineNumberOne: LCDSendCmd(LCDLineAddressOne| col); break;
-		case LCDLineNumberTwo: LCDSendCmd(LCDLineAddressTwo | col); break;
-		case LCDLineNumberThree:
-			switch (_NumColsLCD)
-			{
-				case 16: LCDSendCmd(LCDLineAddress3Col16 | col); break;
-				case 20: LCDSendCmd(LCDLineAddress3Col20 + col); break;
-			}
-		break;
-		case LCDLineNumberFour:
-			switch (_NumColsLCD)
-			{
-				case 16: LCDSendCmd(LCDLineAddress4Col16 | col); break;
-				case 20: LCDSendCmd(LCDLineAddress4Col20 + col); break;
-			}
-		break;
-	}
+/*!
+	@brief  Get the number of glyph loads that uploaded to CGRAM
+	@return miss count
+*/
+uint32_t HD44780PCF8574LCD::LCDGlyphMissesGet(void) { return _GlyphMisses;}
+
+/*!
+	@brief  Zero the glyph hit and miss counts
+*/
+void HD44780PCF8574LCD::LCDGlyphStatsReset(void)
+{
+	_GlyphHits = 0;
+	_GlyphMisses = 0;
 }
 
 /*!
-	@brief  Saves a custom character to a location in character generator RAM 64 bytes.
-	@param location CG_RAM location 0-7, we only have 8 locations 64 bytes
-	@param charmap An array of 8 bytes representing a custom character data
+	@brief  Find a glyph in the registry
+	@param glyphID glyph ID
+	@return registry index, -1 if not registered
 */
-void HD44780PCF8574LCD::LCDCreateCustomChar(uint8_t location, uint8_t * charmap)
+int8_t HD44780PCF8574LCD::LCDGlyphIndexOf(uint16_t glyphID)
 {
+	for (uint8_t index = 0; index < _GlyphCount; index++)
+		if (_GlyphID[index] == glyphID) return index;
+	return -1;
+}
 
-	const uint8_t LCD_CG_RAM = 0x40;  //  character-generator RAM (CG RAM address) 
-	 if (location >= 8) {return;}
-	 
-	LCDSendCmd(LCD_CG_RAM | (location<<3));
-	for (uint8_t i=0; i<8; i++) {
-		LCDSendData(charmap[i]);
+/*!
+	@brief  Pick the CGRAM slot to upload a glyph into
+	@return free slot, else LRU slot not on screen, else LRU slot, 
+		-1 if every slot is reserved by LCDCreateCustomChar
+*/
+int8_t HD44780PCF8574LCD::LCDGlyphVictim(void)
+{
+	int8_t victim = -1;
+	int8_t victimVisible = -1;
+	for (uint8_t slot = 0; slot < LCD_CGRAM_SLOTS; slot++)
+	{
+		if (_GlyphSlotOwner[slot] == LCD_GLYPH_NONE) return slot;
+		if (_GlyphSlotOwner[slot] == LCD_GLYPH_PINNED) continue;
+		if (LCDGlyphVisible(slot) == true)
+		{
+			if (victimVisible < 0 || _GlyphSlotUsed[slot] < _GlyphSlotUsed[victimVisible]) victimVisible = slot;
+		}
+		else if (victim < 0 || _GlyphSlotUsed[slot] < _GlyphSlotUsed[victim])
+		{
+			victim = slot;
+		}
 	}
+	return (victim >= 0) ? victim : victimVisible;
+}
+
+/*!
+	@brief  Check if a CGRAM slot is on screen or about to be
+	@param slot CGRAM slot 0-7
+	@return true if in shadow mode and the slot code (or its 8-15 alias) 
+		is in the shadow buffer or on the glass. Always false when shadow is off.
+*/
+bool HD44780PCF8574LCD::LCDGlyphVisible(uint8_t slot)
+{
+	if (_ShadowON == false) return false;
+	uint8_t size = _NumRowsLCD * _NumColsLCD;
+	for (uint8_t cell = 0; cell < size; cell++)
+	{
+		if ((_ShadowBuffer[cell] & 0xF7) == slot) return true;
+		if (_ShadowGlassValid && (_ShadowGlass[cell] & 0xF7) == slot) return true;
+	}
+	return false;
 }
 
 /*!
@@ -362,7 +1657,7 @@ bool HD44780PCF8574LCD::LCDBackLightGet(void)
 */
 bool HD44780PCF8574LCD::LCD_I2C_ON(void)
 {
-	if (!bcm2835_i2c_begin())
+	if (!_Transport->I2CBegin())
 	{
 		return false;
 	}
@@ -379,20 +1674,19 @@ bool HD44780PCF8574LCD::LCD_I2C_ON(void)
 */
 void HD44780PCF8574LCD::LCD_I2C_SetSpeed()
 {
-		uint32_t I2CBaudRate = 100000;// 100K 
 		// BCM2835_I2C_CLOCK_DIVIDER enum choice 2500 622 150 148
 		// Clock divided is based on nominal base clock rate of 250MHz
 		switch(_LCDSpeedI2C) 
 		{
 			case 0:
 				// default or use set_baudrate instead of clockdivder 100k if zero passed
-				bcm2835_i2c_set_baudrate(I2CBaudRate); 
+				_Transport->I2CSpeedSet(0); 
 			break;
 			case BCM2835_I2C_CLOCK_DIVIDER_2500:// ~100K
 			case BCM2835_I2C_CLOCK_DIVIDER_626: // ~400k
 			case BCM2835_I2C_CLOCK_DIVIDER_150:
 			case BCM2835_I2C_CLOCK_DIVIDER_148:
-				bcm2835_i2c_setClockDivider(_LCDSpeedI2C);
+				_Transport->I2CSpeedSet(_LCDSpeedI2C);
 			break;
 			default:
 				// error message 
@@ -402,7 +1696,7 @@ void HD44780PCF8574LCD::LCD_I2C_SetSpeed()
 					std::cout << "	Must be 2500 626 150 or 148 " <<  std::endl;
 					std::cout << "	Setting I2C baudrate to 100K with bcm2835_i2c_set_baudrate: " <<  std::endl;
 				}
-				bcm2835_i2c_set_baudrate(I2CBaudRate); 
+				_Transport->I2CSpeedSet(0); 
 			break; 
 		}
 }
@@ -412,16 +1706,22 @@ void HD44780PCF8574LCD::LCD_I2C_SetSpeed()
 	@brief End I2C operations
 	@note I2C pins P1-03 (SDA) & P1-05 (SCL) returned to default INPUT behaviour.
 */
-void HD44780PCF8574LCD::LCD_I2C_OFF(void){bcm2835_i2c_end();}
+void HD44780PCF8574LCD::LCD_I2C_OFF(void){_Transport->I2CEnd();}
 
 /*!
 	@brief Print out a customer character from character generator CGRAM 64 bytes 8 characters
 	@param location CGRAM  0-7
+	@return LCDStatus_e
 */
-void HD44780PCF8574LCD::LCDPrintCustomChar(uint8_t location)
+uint8_t HD44780PCF8574LCD::LCDPrintCustomChar(uint8_t location)
 {
-	if (location >= 8) {return;}
-	LCDSendData(location);
+	if (location >= 8) {return LCDStatusOK;}
+	if (_ShadowON == true)
+	{
+		LCDShadowWrite(location);
+		return LCDStatusOK;
+	}
+	return LCDSendData(location);
 }
 
 /*!
@@ -435,31 +1735,67 @@ size_t HD44780PCF8574LCD::write(uint8_t character)
 	return 1;
 }
 
+/*!
+	@brief  Called by print class, writes a buffer of characters in as few I2C transactions as possible
+	@param buffer pointer to the characters to write
+	@param size number of characters
+	@return number of characters written, 0 on I2C failure
+	@note used internally. Overrides the per character default in Print class.
+*/
+size_t HD44780PCF8574LCD::write(const uint8_t *buffer, size_t size)
+{
+	if (_Charset != LCDCharsetRaw)
+	{
+		if (LCDSendText(buffer, size) == LCDStatusOK) return size;
+		setWriteError();
+		return 0;
+	}
+	if (_ShadowON == true)
+	{
+		for (size_t i = 0; i < size; i++) LCDShadowWrite(buffer[i]);
+		return size;
+	}
+	LCDBatchDataRun(buffer, size);
+	if (LCDBatchSend() != 0)
+	{
+		setWriteError();
+		return 0;
+	}
+	return size;
+}
+
 /*!
 	@brief Clear display using software command , set cursor position to zero
+	@return LCDStatus_e
 	@note  See also LCDClearScreen for manual clear
 */
-void HD44780PCF8574LCD::LCDClearScreenCmd(void) {
-	LCDSendCmd(LCDCmdClearScreen);
-	bcm2835_delay(3); // Requires a delay
+uint8_t HD44780PCF8574LCD::LCDClearScreenCmd(void) {
+	uint8_t status = LCDSendCmd(LCDCmdClearScreen);
+	LCDWaitReady(3, LCDExecTimeLongUs);
+	if (_ShadowON == true) LCDShadowFill(0xFF);
+	return status;
 }
 
 /*!
 	@brief Set cursor position to home position .
+	@return LCDStatus_e
 */
-void HD44780PCF8574LCD::LCDHome(void) {
-	LCDSendCmd(LCDCmdHomePosition);
-	bcm2835_delay(3); // Requires a delay
+uint8_t HD44780PCF8574LCD::LCDHome(void) {
+	uint8_t status = LCDSendCmd(LCDCmdHomePosition);
+	LCDWaitReady(3, LCDExecTimeLongUs);
+	return status;
 }
 
 /*!
 	@brief Change entry mode  
 	@param newEntryMode  1-4 , 4 choices.
+	@return LCDStatus_e
 */
-void HD44780PCF8574LCD::LCDChangeEntryMode(LCDEntryMode_e newEntryMode)
+uint8_t HD44780PCF8574LCD::LCDChangeEntryMode(LCDEntryMode_e newEntryMode)
 {
-	LCDSendCmd(newEntryMode);
-	bcm2835_delay(3); // Requires a delay
+	uint8_t status = LCDSendCmd(newEntryMode);
+	LCDWaitReady(3, LCDExecTimeUs);
+	return status;
 }
 
 /*!
@@ -472,6 +1808,314 @@ void HD44780PCF8574LCD::LCDDebugSet(bool OnOff)
 	 OnOff ? (_DebugON  = true) : (_DebugON  = false);
 }
 
+/*!
+	@brief Turn shadow frame buffer mode on or off
+	@param OnOff passed bool True = shadow on , false = shadow off
+	@details When on, LCDSendString LCDSendChar print LCDPrintCustomChar 
+		LCDClearLine LCDClearScreen LCDGOTO and LCDMoveCursor only update an in-memory copy 
+		of the display. flush() then sends the cells that changed since the last flush.
+	@note The shadow assumes entry mode three (increment, no shift), text beyond the
+		last column is clipped. Display contents are unknown when turned on,
+		so first flush sends every cell. Turning it off discards unflushed changes.
+	@return false if turning on was refused, rows x cols is more than the 80 character DDRAM
+*/
+bool HD44780PCF8574LCD::LCDShadowSet(bool OnOff)
+{
+	if (OnOff == true && _NumRowsLCD * _NumColsLCD > LCD_DDRAM_SIZE)
+	{
+		if (_DebugON == true)
+			std::cout << "Error 614: shadow mode, rows x cols bigger than DDRAM : " << _NumRowsLCD * _NumColsLCD << std::endl;
+		return false;
+	}
+	if (OnOff == true && _ShadowON == false)
+	{
+		memset(_ShadowBuffer, ' ', sizeof(_ShadowBuffer));
+		_ShadowGlassValid = false;
+		_ShadowRow = 0;
+		_ShadowCol = 0;
+	}
+	_ShadowON = OnOff;
+	return true;
+}
+
+/*!
+	@brief get shadow frame buffer mode status
+	@return shadow mode status flag
+*/
+bool HD44780PCF8574LCD::LCDShadowGet(void) { return _ShadowON;}
+
+/*!
+	@brief Set if flush() leaves the HD44780 cursor at the shadow cursor
+	@param OnOff true = after sending the changes move the cursor to where the last
+		LCDGOTO / print left the shadow cursor, for a visible cursor. Default false.
+*/
+void HD44780PCF8574LCD::LCDShadowCursorSet(bool OnOff) { _ShadowCursorON = OnOff;}
+
+/*!
+	@brief Check if flush() has anything to send
+	@return true if shadow mode on and any cell differs from the display
+*/
+bool HD44780PCF8574LCD::LCDShadowDirtyGet(void)
+{
+	if (_ShadowON == false) return false;
+	if (_ShadowGlassValid == false) return true;
+	return memcmp(_ShadowBuffer, _ShadowGlass, _NumRowsLCD * _NumColsLCD) != 0;
+}
+
+/*!
+	@brief Write a character into the shadow buffer at the shadow cursor
+	@param data character to write
+*/
+void HD44780PCF8574LCD::LCDShadowWrite(uint8_t data)
+{
+	if (_ShadowRow < _NumRowsLCD && _ShadowCol < _NumColsLCD)
+	{
+		_ShadowBuffer[(_ShadowRow * _NumColsLCD) + _ShadowCol] = data;
+	}
+	if (_ShadowCol < 0xFF) _ShadowCol++;
+}
+
+/*!
+	@brief Fill the shadow buffer with spaces
+	@param row row 0-3 to clear, 0xFF = whole display was cleared by a command, 
+		in which case the glass copy is also reset
+*/
+void HD44780PCF8574LCD::LCDShadowFill(uint8_t row)
+{
+	if (row == 0xFF)
+	{
+		memset(_ShadowBuffer, ' ', sizeof(_ShadowBuffer));
+		memset(_ShadowGlass, ' ', sizeof(_ShadowGlass));
+		_ShadowGlassValid = true;
+		_ShadowRow = 0;
+		_ShadowCol = 0;
+		return;
+	}
+	memset(&_ShadowBuffer[row * _NumColsLCD], ' ', _NumColsLCD);
+	_ShadowRow = row;
+	_ShadowCol = _NumColsLCD;
+}
+
+/*!
+	@brief Send the cells of the shadow buffer that changed since the last flush
+	@details The changed cells are addressed as set by LCDFlushPlanSet, the whole 
+		flush is batched into as few I2C transactions as possible. 
+		Does nothing if shadow mode is off.
+	@note In async mode returns once the changes are queued, see wait().
+*/
+void HD44780PCF8574LCD::flush(void)
+{
+	if (_ShadowON == false) return;
+
+	LCDHealthTick(); // a recovery replays the whole buffer, leaving nothing below to send
+	(_FlushPlan == LCDFlushPerRun) ? LCDFlushPerRunPlan() : LCDFlushCostModelPlan();
+	if (_ShadowCursorON == true && _ShadowRow < _NumRowsLCD && _ShadowCol < _NumColsLCD)
+		LCDBatchAddress(0x80 | LCDCellAddress(_ShadowRow, _ShadowCol));
+	// On failure of any part display contents are unknown, resend every cell on next flush
+	_ShadowGlassValid = (LCDBatchSend() == 0);
+}
+
+/*!
+	@brief Set how flush() addresses the changed cells
+	@param plan LCDFlushCostModel(default) or LCDFlushPerRun, the version 1.4.0 behaviour
+*/
+void HD44780PCF8574LCD::LCDFlushPlanSet(LCDFlushPlan_e plan) { _FlushPlan = plan;}
+
+/*!
+	@brief Get how flush() addresses the changed cells
+	@return LCDFlushPlan_e
+*/
+HD44780PCF8574LCD::LCDFlushPlan_e HD44780PCF8574LCD::LCDFlushPlanGet(void) { return _FlushPlan;}
+
+/*!
+	@brief Queue the changed cells row by row, a set address command before each run
+*/
+void HD44780PCF8574LCD::LCDFlushPerRunPlan(void)
+{
+	for (uint8_t row = 0; row < _NumRowsLCD; row++)
+	{
+		if (LCDCellAddress(row, 0) == HD44780AddressNone) continue;
+		uint8_t *cell = &_ShadowBuffer[row * _NumColsLCD];
+		uint8_t *glass = &_ShadowGlass[row * _NumColsLCD];
+		for (uint8_t col = 0; col < _NumColsLCD; col++)
+		{
+			if (_ShadowGlassValid == true && cell[col] == glass[col]) continue;
+			LCDBatchAddress(0x80 | LCDCellAddress(row, col)); // skipped inside a run
+			LCDBatchData(cell[col]);
+			glass[col] = cell[col];
+		}
+	}
+}
+
+/*!
+	@brief Queue the changed cells in DDRAM address order, using a cost model
+	@details The cells are walked in address counter order, 0x00-0x27 then 0x40-0x67, so a row
+		that carries on in DDRAM from the previous one (rows 1 and 3 of a 20x4, rows 1 and 2
+		of a 40x2) needs no set address command. A gap of unchanged cells between two changed
+		cells is re-sent if that costs no more bus bytes than a set address command.
+		Hidden DDRAM (e.g. 0x10-0x27 of a 16x2) is never written, it always costs an address.
+*/
+void HD44780PCF8574LCD::LCDFlushCostModelPlan(void)
+{
+	const uint8_t noCell = 0xFF;
+	uint8_t cellAt[LCD_DDRAM_LINE * 2]; // walk position to shadow cell index
+	memset(cellAt, noCell, sizeof(cellAt));
+	for (uint8_t row = 0; row < _NumRowsLCD; row++)
+	{
+		if (LCDCellAddress(row, 0) == HD44780AddressNone) continue;
+		for (uint8_t col = 0; col < _NumColsLCD; col++)
+		{
+			uint8_t address = LCDCellAddress(row, col);
+			uint8_t pos = (address & 0x40) ? LCD_DDRAM_LINE + (address & 0x3F) : address;
+			if (pos < sizeof(cellAt)) cellAt[pos] = row * _NumColsLCD + col;
+		}
+	}
+
+	bool streaming = false; // address counter is on the walk, just after the last cell sent
+	uint8_t gap = 0; // unchanged cells walked over since the last cell sent
+	for (uint8_t pos = 0; pos < sizeof(cellAt); pos++)
+	{
+		uint8_t cell = cellAt[pos];
+		if (cell == noCell)
+		{
+			streaming = false;
+			continue;
+		}
+		if (_ShadowGlassValid == true && _ShadowBuffer[cell] == _ShadowGlass[cell])
+		{
+			gap++;
+			continue;
+		}
+		if (streaming == true && gap * LCD_FLUSH_COST_CELL <= LCD_FLUSH_COST_ADDRESS)
+		{
+			for (uint8_t skipped = pos - gap; skipped < pos; skipped++)
+				LCDBatchData(_ShadowBuffer[cellAt[skipped]]);
+		}
+		else
+		{
+			uint8_t address = (pos < LCD_DDRAM_LINE) ? pos : 0x40 + (pos - LCD_DDRAM_LINE);
+			LCDBatchAddress(0x80 | address);
+		}
+		LCDBatchData(_ShadowBuffer[cell]);
+		_ShadowGlass[cell] = _ShadowBuffer[cell];
+		streaming = true;
+		gap = 0;
+	}
+}
+
+/*!
+	@brief Turn on async mode, API calls post bus work to a worker thread and return
+	@param ringSize number of ring slots, each holds 16 LCD bytes or one delay
+	@return false if already on
+	@details Writes and delays are posted into a lock free single producer / single 
+		consumer ring and sent by a worker thread, which also does the I2C error retries 
+		and retry delays. The caller only blocks when the ring is full.
+		Reads (LCDCheckConnection) wait for the ring to drain.
+		The worker follows LCDRetryPolicySet and LCDBreakerSet, a write it gives up on is
+		returned as a LCDStatus_e by the next call that sends, and counts towards the breaker.
+	@note Call all LCD methods from one thread.
+*/
+bool HD44780PCF8574LCD::LCDAsyncBegin(uint16_t ringSize)
+{
+	if (_TransportAsync) return false;
+	_TransportAsync.reset(new HD44780TransportAsync(*_Transport, ringSize));
+	_AsyncErrorsSeen = 0;
+	LCDAsyncPolicySet();
+	_Transport = _TransportAsync.get();
+	return true;
+}
+
+/*!
+	@brief Async mode, pick up the writes the worker gave up on since the last call
+	@return bcm2835I2CReasonCodes of the last of them, 0x00 if none
+	@details Failures are handled as in LCDBatchSend, only one call later. The breaker
+		opens on the worker count of consecutive failed writes, then the worker drops 
+		writes already posted, with no retries or delays, until a probe closes it.
+*/
+uint8_t HD44780PCF8574LCD::LCDAsyncStatus(void) {
+	uint32_t errors = _TransportAsync->AsyncErrorCountGet();
+	uint32_t streak = _TransportAsync->AsyncFailStreakGet();
+	_BreakerFailures = (streak > 0xFF) ? 0xFF : streak;
+	if (errors == _AsyncErrorsSeen)
+	{
+		_I2C_ErrorFlag = LCDStatusOK;
+		return LCDStatusOK;
+	}
+
+	_Stats.Failures += errors - _AsyncErrorsSeen;
+	_AsyncErrorsSeen = errors;
+	_CursorKnown = false;
+	_CGRAMAddress = HD44780AddressNone;
+	_ShadowGlassValid = false; // cells of a lost write are sent again by the next flush
+	_HealthSuspect = true;
+	if (_BreakerThreshold > 0 && _BreakerOpen == false && _BreakerFailures >= _BreakerThreshold) LCDBreakerTrip();
+	_I2C_ErrorFlag = _TransportAsync->AsyncErrorGet();
+	return _I2C_ErrorFlag;
+}
+
+/*!
+	@brief Async mode, give the worker the retry policy and breaker threshold
+*/
+void HD44780PCF8574LCD::LCDAsyncPolicySet(void) {
+	if (!_TransportAsync) return;
+	if (_RetryPolicy == LCDRetryBackoff)
+		_TransportAsync->AsyncRetrySet(_I2C_ErrorRetryNum, _RetryBaseMs, true, _RetryMaxMs);
+	else
+		_TransportAsync->AsyncRetrySet(_I2C_ErrorRetryNum, _I2C_ErrorDelay);
+	_TransportAsync->AsyncBreakerSet(_BreakerThreshold);
+}
+
+/*!
+	@brief Turn off async mode, waits for queued work to be sent then stops the worker thread
+*/
+void HD44780PCF8574LCD::LCDAsyncEnd(void)
+{
+	if (!_TransportAsync) return;
+	_Transport = &_TransportAsync->AsyncInnerGet();
+	_TransportAsync.reset();
+}
+
+/*!
+	@brief get async mode status
+	@return true if async mode on
+*/
+bool HD44780PCF8574LCD::LCDAsyncGet(void) { return (_TransportAsync != nullptr);}
+
+/*!
+	@brief Barrier, block until all bus work posted so far has been sent
+	@note Returns at once if async mode off.
+*/
+void HD44780PCF8574LCD::wait(void)
+{
+	if (_TransportAsync) _TransportAsync->AsyncWait();
+}
+
+/*!
+	@brief get the max async ring depth, in slots, since LCDAsyncBegin or last reset
+	@return high water mark, 0 if async mode off
+*/
+uint16_t HD44780PCF8574LCD::LCDAsyncHighWaterGet(void)
+{
+	return _TransportAsync ? _TransportAsync->AsyncHighWaterGet() : 0;
+}
+
+/*!
+	@brief reset the async ring depth high water mark
+*/
+void HD44780PCF8574LCD::LCDAsyncHighWaterReset(void)
+{
+	if (_TransportAsync) _TransportAsync->AsyncHighWaterReset();
+}
+
+/*!
+	@brief get the number of async writes that failed after all retries
+	@return error count, 0 if async mode off
+*/
+uint32_t HD44780PCF8574LCD::LCDAsyncErrorCountGet(void)
+{
+	return _TransportAsync ? _TransportAsync->AsyncErrorCountGet() : 0;
+}
+
 /*!
 	 @brief get DEBUG mode status
 	 @return debug mode status flag
@@ -497,6 +2141,24 @@ int16_t  HD44780PCF8574LCD::LCDVerNumGet(void){return _LibVersionNum;}
 */
 uint8_t HD44780PCF8574LCD::LCDI2CErrorGet(void) { return _I2C_ErrorFlag;}
 
+/*!
+	 @brief get the PCF8574 I2C address
+	 @return I2C address passed to constructor
+*/
+uint8_t HD44780PCF8574LCD::LCDI2CAddressGet(void) { return _LCDSlaveAddresI2C;}
+
+/*!
+	 @brief get the number of rows
+	 @return rows passed to constructor
+*/
+uint8_t HD44780PCF8574LCD::LCDRowsGet(void) { return _NumRowsLCD;}
+
+/*!
+	 @brief get the number of columns
+	 @return columns passed to constructor
+*/
+uint8_t HD44780PCF8574LCD::LCDColsGet(void) { return _NumColsLCD;}
+
 /*!
 	 @brief Sets the I2C timeout, in the event of an I2C write error
 	 @details Delay between retry attempts in event of an error , mS
@@ -505,6 +2167,7 @@ uint8_t HD44780PCF8574LCD::LCDI2CErrorGet(void) { return _I2C_ErrorFlag;}
 void HD44780PCF8574LCD::LCDI2CErrorTimeoutSet(uint16_t newTimeout)
 {
 	_I2C_ErrorDelay = newTimeout;
+	LCDAsyncPolicySet();
 }
 
 /*!
@@ -529,6 +2192,7 @@ uint8_t HD44780PCF8574LCD::LCDI2CErrorRetryNumGet(void){return _I2C_ErrorRetryNu
 void HD44780PCF8574LCD::LCDI2CErrorRetryNumSet(uint8_t AttemptCount)
 {
 	_I2C_ErrorRetryNum = AttemptCount;
+	LCDAsyncPolicySet();
 }
 
 
@@ -540,8 +2204,8 @@ uint8_t HD44780PCF8574LCD::LCDCheckConnection(void)
 {
 	char rxdata[1]; //buffer to hold return byte
 	
-	bcm2835_i2c_setSlaveAddress(_LCDSlaveAddresI2C);  // set i2c address
-	_I2C_ErrorFlag = bcm2835_i2c_read(rxdata, 1); // returns reason code , 0 success
+	_Transport->I2CAddressSet(_LCDSlaveAddresI2C);  // set i2c address
+	_I2C_ErrorFlag = _Transport->I2CRead(rxdata, 1); // returns reason code , 0 success
 
 	return _I2C_ErrorFlag;
 }
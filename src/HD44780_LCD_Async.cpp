@@ -0,0 +1,352 @@
+/*!
+	@file     HD44780_LCD_Async.cpp
+	@author   Gavin Lyons
+	@brief    Asynchronous bus transport for HD44780_LCD library, lock free command ring
+		drained by a worker thread
+	@details  URL: https://github.com/gavinlyonsrepo/HD44780_LCD_RPI
+*/
+
+// Section : Includes
+#include <chrono>
+#include <cstring>
+#include "HD44780_LCD_Async.hpp"
+
+/*!
+	@brief Constructor for class HD44780TransportAsync, starts the worker thread
+	@param inner transport the worker sends to, must outlive this object
+	@param ringSize number of ring slots, rounded up to a power of two, max 32768.
+		Each slot holds 16 LCD bytes or one delay.
+*/
+HD44780TransportAsync::HD44780TransportAsync(HD44780Transport &inner, uint16_t ringSize) : _Inner(inner)
+{
+	uint32_t size = 2;
+	while (size < ringSize && size < ASYNC_RING_MAX) size <<= 1;
+	_RingMask = size - 1;
+	_Ring.reset(new AsyncOp[size]);
+	_Worker = std::thread(&HD44780TransportAsync::AsyncWorker, this);
+}
+
+/*!
+	@brief Destructor, sends everything still in the ring then stops the worker thread
+*/
+HD44780TransportAsync::~HD44780TransportAsync()
+{
+	{
+		std::lock_guard<std::mutex> lock(_WakeMutex);
+		_Stop.store(true);
+	}
+	_WakeCondition.notify_one();
+	if (_Worker.joinable()) _Worker.join();
+}
+
+// Section : Transport methods
+
+/*!
+	@brief Wait for the ring to drain then start I2C operations on the inner transport
+	@return false for failure to switch on.
+*/
+bool HD44780TransportAsync::I2CBegin(void)
+{
+	AsyncWait();
+	return _Inner.I2CBegin();
+}
+
+/*!
+	@brief Wait for the ring to drain then end I2C operations on the inner transport
+*/
+void HD44780TransportAsync::I2CEnd(void)
+{
+	AsyncWait();
+	_Inner.I2CEnd();
+}
+
+/*!
+	@brief Wait for the ring to drain then set the inner transport bus speed
+	@param speed 0 = 100K baudrate, > 0 BCM2835_I2C_CLOCK_DIVIDER value
+*/
+void HD44780TransportAsync::I2CSpeedSet(uint16_t speed)
+{
+	AsyncWait();
+	_Inner.I2CSpeedSet(speed);
+}
+
+/*!
+	@brief Set I2C slave address for following posted writes
+	@param address I2C address
+*/
+void HD44780TransportAsync::I2CAddressSet(uint8_t address) { _Address = address;}
+
+/*!
+	@brief Post a write into the ring, sent later as one I2C transaction by the worker
+	@param buffer bytes to write, copied
+	@param length number of bytes
+	@return BCM2835_I2C_REASON_OK, failures are counted by the worker see AsyncErrorGet
+	@note Blocks only while the ring is full.
+*/
+uint8_t HD44780TransportAsync::I2CWrite(const char *buffer, uint32_t length)
+{
+	while (length > 0)
+	{
+		uint16_t size = (length > ASYNC_SLOT_DATA) ? ASYNC_SLOT_DATA : length;
+		AsyncOp &op = AsyncReserve();
+		op.Type = AsyncOpWrite;
+		op.Address = _Address;
+		op.Length = size;
+		op.More = (length > size);
+		op.PrefixLength = _PrefixNextLength;
+		memcpy(op.Prefix, _PrefixNext, _PrefixNextLength);
+		_PrefixNextLength = 0; // first slot only
+		memcpy(op.Data, buffer, size);
+		AsyncCommit();
+		buffer += size;
+		length -= size;
+	}
+	return BCM2835_I2C_REASON_OK;
+}
+
+/*!
+	@brief Wait for the ring to drain then read from the inner transport
+	@param buffer buffer to hold read bytes
+	@param length number of bytes
+	@return bcm2835I2CReasonCodes , BCM2835_I2C_REASON_OK 0x00 = Success
+*/
+uint8_t HD44780TransportAsync::I2CRead(char *buffer, uint32_t length)
+{
+	AsyncWait();
+	_Inner.I2CAddressSet(_Address);
+	return _Inner.I2CRead(buffer, length);
+}
+
+/*!
+	@brief Post a delay into the ring, the worker waits, the caller does not
+	@param ms delay
+*/
+void HD44780TransportAsync::DelayMs(uint32_t ms)
+{
+	AsyncOp &op = AsyncReserve();
+	op.Type = AsyncOpDelayMs;
+	op.Arg = ms;
+	AsyncCommit();
+}
+
+/*!
+	@brief Post a delay into the ring, the worker waits, the caller does not
+	@param us delay
+*/
+void HD44780TransportAsync::DelayUs(uint32_t us)
+{
+	AsyncOp &op = AsyncReserve();
+	op.Type = AsyncOpDelayUs;
+	op.Arg = us;
+	AsyncCommit();
+}
+
+// Section : Ring
+
+/*!
+	@brief Get the next free slot, waits while the ring is full
+	@return slot, filled by caller then published with AsyncCommit
+*/
+HD44780TransportAsync::AsyncOp &HD44780TransportAsync::AsyncReserve(void)
+{
+	uint32_t tail = _Tail.load(std::memory_order_relaxed);
+	while (tail - _Head.load(std::memory_order_acquire) > _RingMask)
+		std::this_thread::yield();
+	return _Ring[tail & _RingMask];
+}
+
+/*!
+	@brief Publish the slot from AsyncReserve to the worker
+*/
+void HD44780TransportAsync::AsyncCommit(void)
+{
+	uint32_t tail = _Tail.load(std::memory_order_relaxed) + 1;
+	_Tail.store(tail);
+	uint32_t depth = tail - _Head.load(std::memory_order_acquire);
+	if (depth > _HighWater.load(std::memory_order_relaxed))
+		_HighWater.store(static_cast<uint16_t>(depth), std::memory_order_relaxed);
+	if (_Sleeping.load())
+	{
+		std::lock_guard<std::mutex> lock(_WakeMutex);
+		_WakeCondition.notify_one();
+	}
+}
+
+/*!
+	@brief Worker thread, drains the ring into the inner transport
+*/
+void HD44780TransportAsync::AsyncWorker(void)
+{
+	while (true)
+	{
+		uint32_t head = _Head.load(std::memory_order_relaxed);
+		if (head == _Tail.load(std::memory_order_acquire))
+		{
+			if (_Stop.load()) break;
+			std::unique_lock<std::mutex> lock(_WakeMutex);
+			_Sleeping.store(true);
+			_WakeCondition.wait(lock, [this]{ return _Head.load() != _Tail.load() || _Stop.load(); });
+			_Sleeping.store(false);
+			continue;
+		}
+		AsyncExecute(_Ring[head & _RingMask]);
+		_Head.store(head + 1, std::memory_order_release);
+	}
+}
+
+/*!
+	@brief Worker, run one slot on the inner transport
+	@param op the slot
+	@details Write slots are joined until the last one of the write,
+		which is then sent with retries, the retry prefix of the write ahead of each retry.
+		While the breaker is open the write is dropped unsent and counted as failed.
+*/
+void HD44780TransportAsync::AsyncExecute(const AsyncOp &op)
+{
+	switch (op.Type)
+	{
+		case AsyncOpDelayMs: _Inner.DelayMs(op.Arg); return;
+		case AsyncOpDelayUs: _Inner.DelayUs(op.Arg); return;
+		default: break;
+	}
+
+	if (_WorkerBuffer.empty())
+	{
+		_WorkerPrefixLength = op.PrefixLength;
+		memcpy(_WorkerPrefix, op.Prefix, op.PrefixLength);
+	}
+	_WorkerBuffer.insert(_WorkerBuffer.end(), op.Data, op.Data + op.Length);
+	if (op.More) return;
+
+	uint8_t threshold = _BreakerThreshold.load();
+	if (threshold > 0 && _FailStreak.load() >= threshold) // breaker open
+	{
+		_FailStreak++;
+		_ErrorCount++;
+		_WorkerBuffer.clear();
+		return;
+	}
+
+	_Inner.I2CAddressSet(op.Address);
+	uint8_t ReasonCodes = _Inner.I2CWrite(_WorkerBuffer.data(), _WorkerBuffer.size());
+	if (ReasonCodes != 0 && _WorkerPrefixLength > 0) // part of the write may be on the display
+		_WorkerBuffer.insert(_WorkerBuffer.begin(), _WorkerPrefix, _WorkerPrefix + _WorkerPrefixLength);
+	for (uint8_t attempt = 0; ReasonCodes != 0 && attempt < _RetryNum.load(); attempt++)
+	{
+		uint16_t delay = _RetryBackoff.load() ? 
+			HD44780RetryBackoffMs(attempt, _RetryDelay.load(), _RetryMaxMs.load(), _RetryJitter) : _RetryDelay.load();
+		if (delay > 0) _Inner.DelayMs(delay);
+		ReasonCodes = _Inner.I2CWrite(_WorkerBuffer.data(), _WorkerBuffer.size()); // retransmit
+	}
+	if (ReasonCodes != 0)
+	{
+		_FailStreak++;
+		_ErrorCount++;
+		_LastError.store(ReasonCodes);
+	}
+	else
+	{
+		_FailStreak.store(0);
+	}
+	_WorkerBuffer.clear();
+}
+
+// Section : Barriers and counters
+
+/*!
+	@brief Block until the worker has sent everything posted so far
+*/
+void HD44780TransportAsync::AsyncWait(void)
+{
+	while (_Head.load(std::memory_order_acquire) != _Tail.load(std::memory_order_relaxed))
+		std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+/*!
+	@brief Set the worker retry policy for failed writes
+	@param retryNum retry attempts
+	@param retryDelay delay between attempts mS, the worker waits, the caller does not.
+		With backoff the delay before the second retry.
+	@param backoff false = fixed delay, true = first retry immediate then HD44780RetryBackoffMs
+	@param backoffMaxMs backoff delay cap mS
+*/
+void HD44780TransportAsync::AsyncRetrySet(uint8_t retryNum, uint16_t retryDelay, bool backoff, uint16_t backoffMaxMs)
+{
+	_RetryNum.store(retryNum);
+	_RetryDelay.store(retryDelay);
+	_RetryBackoff.store(backoff);
+	_RetryMaxMs.store(backoffMaxMs);
+}
+
+/*!
+	@brief Set frames the worker sends ahead of the next posted write if it has to be retried
+	@param frames e.g. a set address command, so bytes of a failed attempt that reached
+		the display are written over, not written twice
+	@param length bytes, up to ASYNC_PREFIX_MAX, 0 = none
+*/
+void HD44780TransportAsync::AsyncRetryPrefixSet(const char *frames, uint8_t length)
+{
+	if (length > ASYNC_PREFIX_MAX) length = 0;
+	memcpy(_PrefixNext, frames, length);
+	_PrefixNextLength = length;
+}
+
+/*!
+	@brief Set the worker circuit breaker
+	@param threshold consecutive failed writes after which following writes are dropped
+		unsent until AsyncBreakerReset, 0 = off(default)
+*/
+void HD44780TransportAsync::AsyncBreakerSet(uint8_t threshold) { _BreakerThreshold.store(threshold);}
+
+/*!
+	@brief Close the worker circuit breaker, writes are sent again
+	@note Call once the display has answered, e.g. a read.
+*/
+void HD44780TransportAsync::AsyncBreakerReset(void) { _FailStreak.store(0);}
+
+/*!
+	@brief Get the number of consecutive writes that failed after all retries or were dropped
+	@return 0 after a write succeeds
+*/
+uint32_t HD44780TransportAsync::AsyncFailStreakGet(void) { return _FailStreak.load();}
+
+/*!
+	@brief Get the transport the worker sends to
+	@return inner transport
+*/
+HD44780Transport &HD44780TransportAsync::AsyncInnerGet(void) { return _Inner;}
+
+/*!
+	@brief Get the number of slots waiting in the ring
+	@return ring depth
+*/
+uint16_t HD44780TransportAsync::AsyncDepthGet(void)
+{
+	return _Tail.load(std::memory_order_relaxed) - _Head.load(std::memory_order_acquire);
+}
+
+/*!
+	@brief Get the max ring depth seen since start or last reset
+	@return high water mark in slots
+*/
+uint16_t HD44780TransportAsync::AsyncHighWaterGet(void) { return _HighWater.load();}
+
+/*!
+	@brief Reset the ring depth high water mark
+*/
+void HD44780TransportAsync::AsyncHighWaterReset(void) { _HighWater.store(0);}
+
+/*!
+	@brief Get the number of writes that failed after all retries, or were dropped while
+		the breaker was open
+	@return error count
+*/
+uint32_t HD44780TransportAsync::AsyncErrorCountGet(void) { return _ErrorCount.load();}
+
+/*!
+	@brief Get the reason code of the last write that failed after all retries
+	@return bcm2835I2CReasonCodes, 0x00 = no failure yet
+*/
+uint8_t HD44780TransportAsync::AsyncErrorGet(void) { return _LastError.load();}
+
+// **** EOF ****
@@ -0,0 +1,447 @@
+/*!
+	@file     HD44780_LCD_Daemon.cpp
+	@author   Gavin Lyons
+	@brief    Display daemon for HD44780_LCD library, shared memory framebuffers
+		and Unix domain socket commands.
+	@details  URL: https://github.com/gavinlyonsrepo/HD44780_LCD_RPI
+*/
+
+// Section : Includes
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "HD44780_LCD_Daemon.hpp"
+
+// Section : Defines
+static uint64_t HD44780DaemonNowUs(void)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Section : HD44780LCDDaemon
+
+/*!
+	@brief Constructor for class HD44780LCDDaemon
+	@param rateHz flushes per second, 1-1000
+*/
+HD44780LCDDaemon::HD44780LCDDaemon(uint16_t rateHz)
+{
+	DaemonRateSet(rateHz);
+}
+
+/*!
+	@brief Destructor, removes the shared memory and sockets of every display
+*/
+HD44780LCDDaemon::~HD44780LCDDaemon()
+{
+	for (uint8_t index = 0; index < _NumPanels; index++) DaemonRemove(_Panels[index]);
+}
+
+/*!
+	@brief Serve a display
+	@param display initialised display, must outlive the daemon, switched to shadow mode
+	@param name short name, e.g. "front", used for /hd44780_front and /tmp/hd44780_front.sock
+	@return false if too many displays, or the shared memory or socket can not be created
+	@details The framebuffer starts as spaces, so the display is cleared on the first flush.
+		Any stale socket file of the same name is removed.
+*/
+bool HD44780LCDDaemon::DaemonAdd(HD44780PCF8574LCD &display, const std::string &name)
+{
+	if (_NumPanels >= DAEMON_MAX_PANELS || name.empty()) return false;
+	uint8_t rows = display.LCDRowsGet();
+	uint8_t cols = display.LCDColsGet();
+	if (rows * cols > static_cast<int>(sizeof(HD44780DaemonShm::Cells))) return false;
+
+	DaemonPanel &panel = _Panels[_NumPanels];
+	panel = DaemonPanel();
+	panel.Display = &display;
+	panel.Name = name;
+	for (uint8_t client = 0; client < DAEMON_MAX_CLIENTS; client++) panel.Clients[client] = -1;
+
+	int fd = shm_open(DaemonShmName(name).c_str(), O_CREAT | O_RDWR, 0666);
+	if (fd < 0) return false;
+	void *map = MAP_FAILED;
+	if (ftruncate(fd, sizeof(HD44780DaemonShm)) == 0)
+		map = mmap(nullptr, sizeof(HD44780DaemonShm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+	{
+		shm_unlink(DaemonShmName(name).c_str());
+		return false;
+	}
+	panel.Shm = static_cast<HD44780DaemonShm *>(map);
+	panel.Shm->Magic = 0;
+	panel.Shm->Rows = rows;
+	panel.Shm->Cols = cols;
+	panel.Shm->RateHz = _RateHz;
+	panel.Shm->Flushes = 0;
+	memset(panel.Shm->Cells, ' ', sizeof(panel.Shm->Cells));
+	__atomic_store_n(&panel.Shm->Magic, HD44780_DAEMON_MAGIC, __ATOMIC_RELEASE);
+
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	std::string path = DaemonSocketPath(name);
+	if (path.size() >= sizeof(address.sun_path))
+	{
+		DaemonRemove(panel);
+		return false;
+	}
+	strcpy(address.sun_path, path.c_str());
+	unlink(path.c_str());
+	panel.ListenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (panel.ListenFd < 0
+		|| bind(panel.ListenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0
+		|| listen(panel.ListenFd, DAEMON_MAX_CLIENTS) != 0)
+	{
+		DaemonRemove(panel);
+		return false;
+	}
+
+	display.LCDShadowSet(true);
+	display.LCDShadowCursorSet(true);
+	_NumPanels++;
+	return true;
+}
+
+/*!
+	@brief Serve commands and flush the framebuffers when due
+	@param timeoutMs longest wait for a command, -1 = until the next flush
+	@return false once a quit command is received or DaemonStop called
+	@details Returns after a flush, after commands were served, or after timeoutMs.
+		A late flush is not caught up, the next one is one period later.
+*/
+bool HD44780LCDDaemon::DaemonPoll(int timeoutMs)
+{
+	if (_Running == false) return false;
+
+	pollfd fds[DAEMON_MAX_PANELS * (DAEMON_MAX_CLIENTS + 1)];
+	uint8_t owner[DAEMON_MAX_PANELS * (DAEMON_MAX_CLIENTS + 1)]; // panel of each fd
+	int8_t slot[DAEMON_MAX_PANELS * (DAEMON_MAX_CLIENTS + 1)]; // client index, -1 = listening socket
+	nfds_t count = 0;
+	for (uint8_t index = 0; index < _NumPanels; index++)
+	{
+		fds[count] = {_Panels[index].ListenFd, POLLIN, 0};
+		owner[count] = index;
+		slot[count++] = -1;
+		for (uint8_t client = 0; client < DAEMON_MAX_CLIENTS; client++)
+		{
+			if (_Panels[index].Clients[client] < 0) continue;
+			fds[count] = {_Panels[index].Clients[client], POLLIN, 0};
+			owner[count] = index;
+			slot[count++] = client;
+		}
+	}
+
+	uint64_t now = HD44780DaemonNowUs();
+	int wait = (_NextFlushUs > now) ? static_cast<int>((_NextFlushUs - now + 999) / 1000) : 0;
+	if (timeoutMs >= 0 && timeoutMs < wait) wait = timeoutMs;
+	if (poll(fds, count, wait) > 0)
+	{
+		for (nfds_t index = 0; index < count; index++)
+		{
+			if (fds[index].revents == 0) continue;
+			if (slot[index] < 0) DaemonAccept(_Panels[owner[index]]);
+			else DaemonRead(_Panels[owner[index]], slot[index]);
+		}
+	}
+
+	now = HD44780DaemonNowUs();
+	if (_Running == true && now >= _NextFlushUs)
+	{
+		for (uint8_t index = 0; index < _NumPanels; index++) DaemonFlush(_Panels[index]);
+		uint64_t period = 1000000 / _RateHz;
+		_NextFlushUs = (_NextFlushUs + period > now) ? _NextFlushUs + period : now + period;
+	}
+	return _Running;
+}
+
+/*!
+	@brief Serve until a quit command is received or DaemonStop called
+*/
+void HD44780LCDDaemon::DaemonRun(void)
+{
+	while (DaemonPoll(-1) == true) {}
+}
+
+/*!
+	@brief Make DaemonPoll return false, call from the daemon thread or a signal handler
+*/
+void HD44780LCDDaemon::DaemonStop(void) { _Running = false;}
+
+/*!
+	@brief Get the flush rate
+	@return flushes per second
+*/
+uint16_t HD44780LCDDaemon::DaemonRateGet(void) { return _RateHz;}
+
+/*!
+	@brief Set the flush rate
+	@param rateHz flushes per second, limited to 1-1000
+*/
+void HD44780LCDDaemon::DaemonRateSet(uint16_t rateHz)
+{
+	_RateHz = (rateHz < 1) ? 1 : (rateHz > 1000) ? 1000 : rateHz;
+	for (uint8_t index = 0; index < _NumPanels; index++) _Panels[index].Shm->RateHz = _RateHz;
+}
+
+/*!
+	@brief Get the shared memory object name of a display
+	@param name display name passed to DaemonAdd
+	@return name for shm_open
+*/
+std::string HD44780LCDDaemon::DaemonShmName(const std::string &name) { return "/hd44780_" + name;}
+
+/*!
+	@brief Get the command socket path of a display
+	@param name display name passed to DaemonAdd
+	@return socket file path
+*/
+std::string HD44780LCDDaemon::DaemonSocketPath(const std::string &name) { return "/tmp/hd44780_" + name + ".sock";}
+
+/*!
+	@brief Copy the framebuffer into the shadow buffer and send the changed cells
+	@param panel display to flush
+*/
+void HD44780LCDDaemon::DaemonFlush(DaemonPanel &panel)
+{
+	uint8_t cells[sizeof(HD44780DaemonShm::Cells)];
+	memcpy(cells, panel.Shm->Cells, sizeof(cells));
+	HD44780PCF8574LCD &display = *panel.Display;
+	uint8_t cols = display.LCDColsGet(); // not from the framebuffer, clients can write it
+	for (uint8_t row = 0; row < display.LCDRowsGet(); row++)
+	{
+		display.LCDGOTO(static_cast<HD44780PCF8574LCD::LCDLineNumber_e>(row + 1), 0);
+		display.write(&cells[row * cols], cols);
+	}
+	display.LCDGOTO(static_cast<HD44780PCF8574LCD::LCDLineNumber_e>(panel.CursorRow + 1), panel.CursorCol);
+	display.flush();
+	__atomic_add_fetch(&panel.Shm->Flushes, 1, __ATOMIC_RELEASE);
+}
+
+/*!
+	@brief Accept waiting clients, refused if DAEMON_MAX_CLIENTS connected
+	@param panel display whose socket is readable
+*/
+void HD44780LCDDaemon::DaemonAccept(DaemonPanel &panel)
+{
+	int fd;
+	while ((fd = accept4(panel.ListenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+	{
+		uint8_t client = 0;
+		while (client < DAEMON_MAX_CLIENTS && panel.Clients[client] >= 0) client++;
+		if (client == DAEMON_MAX_CLIENTS)
+		{
+			close(fd);
+			continue;
+		}
+		panel.Clients[client] = fd;
+		panel.InputLen[client] = 0;
+	}
+}
+
+/*!
+	@brief Read from a client and serve each complete line
+	@param panel display the client is connected to
+	@param client index in panel.Clients
+*/
+void HD44780LCDDaemon::DaemonRead(DaemonPanel &panel, uint8_t client)
+{
+	char buffer[256];
+	ssize_t length = recv(panel.Clients[client], buffer, sizeof(buffer), 0);
+	if (length <= 0)
+	{
+		if (length < 0 && (errno == EAGAIN || errno == EINTR)) return;
+		close(panel.Clients[client]);
+		panel.Clients[client] = -1;
+		return;
+	}
+	for (ssize_t index = 0; index < length && panel.Clients[client] >= 0; index++)
+	{
+		char &next = panel.Input[client][panel.InputLen[client]];
+		if (buffer[index] != '\n')
+		{
+			if (panel.InputLen[client] < DAEMON_LINE_MAX - 1) panel.InputLen[client]++;
+			next = buffer[index];
+			continue;
+		}
+		next = '\0';
+		std::string reply = (panel.InputLen[client] == DAEMON_LINE_MAX - 1)
+			? "ERR line too long\n" : DaemonCommand(panel, panel.Input[client]);
+		panel.InputLen[client] = 0;
+		send(panel.Clients[client], reply.data(), reply.size(), MSG_NOSIGNAL);
+	}
+}
+
+/*!
+	@brief Carry out one command line
+	@param panel display the command is for
+	@param line command, no newline
+	@return reply line
+*/
+std::string HD44780LCDDaemon::DaemonCommand(DaemonPanel &panel, const char *line)
+{
+	HD44780PCF8574LCD &display = *panel.Display;
+	char word[16] = "";
+	unsigned int a = 0, b = 0;
+	unsigned int bitmap[8];
+
+	if (sscanf(line, "cursor %u %u", &a, &b) == 2)
+	{
+		if (a >= display.LCDRowsGet() || b >= display.LCDColsGet()) return "ERR out of range\n";
+		panel.CursorRow = a;
+		panel.CursorCol = b;
+	}
+	else if (sscanf(line, "cursortype %15s", word) == 1)
+	{
+		if (strcmp(word, "off") == 0) panel.CursorType = display.LCDCursorTypeOff;
+		else if (strcmp(word, "on") == 0) panel.CursorType = display.LCDCursorTypeOn;
+		else if (strcmp(word, "blink") == 0) panel.CursorType = display.LCDCursorTypeBlink;
+		else if (strcmp(word, "onblink") == 0) panel.CursorType = display.LCDCursorTypeOnBlink;
+		else return "ERR cursor type\n";
+		if (display.LCDCursorTypeSet(panel.CursorType) != 0) return "ERR I2C\n";
+	}
+	else if (sscanf(line, "backlight %15s", word) == 1)
+	{
+		if (strcmp(word, "on") != 0 && strcmp(word, "off") != 0) return "ERR backlight\n";
+		display.LCDBackLightSet(strcmp(word, "on") == 0);
+		if (display.LCDCursorTypeSet(panel.CursorType) != 0) return "ERR I2C\n";
+	}
+	else if (sscanf(line, "glyph %u %x %x %x %x %x %x %x %x", &a, &bitmap[0], &bitmap[1], &bitmap[2],
+		&bitmap[3], &bitmap[4], &bitmap[5], &bitmap[6], &bitmap[7]) == 9)
+	{
+		if (a >= 8) return "ERR slot\n";
+		uint8_t charmap[8];
+		for (uint8_t i = 0; i < 8; i++) charmap[i] = bitmap[i] & 0x1F;
+		if (display.LCDCreateCustomChar(a, charmap) != 0) return "ERR I2C\n";
+	}
+	else if (sscanf(line, "rate %u", &a) == 1)
+	{
+		if (a < 1 || a > 1000) return "ERR rate\n";
+		DaemonRateSet(a);
+	}
+	else if (strcmp(line, "flush") == 0) DaemonFlush(panel);
+	else if (strcmp(line, "quit") == 0) _Running = false;
+	else return "ERR unknown command\n";
+	return "OK\n";
+}
+
+/*!
+	@brief Close the sockets of a display and remove its shared memory and socket file
+	@param panel display to remove
+*/
+void HD44780LCDDaemon::DaemonRemove(DaemonPanel &panel)
+{
+	for (uint8_t client = 0; client < DAEMON_MAX_CLIENTS; client++)
+	{
+		if (panel.Clients[client] >= 0) close(panel.Clients[client]);
+		panel.Clients[client] = -1;
+	}
+	if (panel.ListenFd >= 0)
+	{
+		close(panel.ListenFd);
+		unlink(DaemonSocketPath(panel.Name).c_str());
+		panel.ListenFd = -1;
+	}
+	if (panel.Shm != nullptr)
+	{
+		munmap(panel.Shm, sizeof(HD44780DaemonShm));
+		shm_unlink(DaemonShmName(panel.Name).c_str());
+		panel.Shm = nullptr;
+	}
+}
+
+// Section : HD44780DaemonClient
+
+/*!
+	@brief Destructor, unmaps the framebuffer and closes the socket
+*/
+HD44780DaemonClient::~HD44780DaemonClient() { ClientClose();}
+
+/*!
+	@brief Connect to a display served by HD44780LCDDaemon
+	@param name display name passed to DaemonAdd
+	@return false if the daemon is not serving the display
+*/
+bool HD44780DaemonClient::ClientOpen(const std::string &name)
+{
+	ClientClose();
+	int fd = shm_open(HD44780LCDDaemon::DaemonShmName(name).c_str(), O_RDWR, 0);
+	if (fd < 0) return false;
+	void *map = mmap(nullptr, sizeof(HD44780DaemonShm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) return false;
+	_Shm = static_cast<HD44780DaemonShm *>(map);
+
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	std::string path = HD44780LCDDaemon::DaemonSocketPath(name);
+	strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+	_Socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (__atomic_load_n(&_Shm->Magic, __ATOMIC_ACQUIRE) != HD44780_DAEMON_MAGIC || _Socket < 0
+		|| connect(_Socket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+	{
+		ClientClose();
+		return false;
+	}
+	return true;
+}
+
+/*!
+	@brief Disconnect from the daemon
+*/
+void HD44780DaemonClient::ClientClose(void)
+{
+	if (_Socket >= 0) close(_Socket);
+	_Socket = -1;
+	if (_Shm != nullptr) munmap(_Shm, sizeof(HD44780DaemonShm));
+	_Shm = nullptr;
+}
+
+/*!
+	@brief Get the mapped framebuffer, write Cells directly
+	@return framebuffer, nullptr if not open
+*/
+HD44780DaemonShm *HD44780DaemonClient::ClientShmGet(void) { return _Shm;}
+
+/*!
+	@brief Write text into the framebuffer, clipped at the end of the row
+	@param row row 0-3
+	@param col column
+	@param text characters to write
+*/
+void HD44780DaemonClient::ClientPrint(uint8_t row, uint8_t col, const std::string &text)
+{
+	if (_Shm == nullptr || row >= _Shm->Rows) return;
+	for (size_t index = 0; index < text.size() && col < _Shm->Cols; index++, col++)
+		_Shm->Cells[(row * _Shm->Cols) + col] = text[index];
+}
+
+/*!
+	@brief Send a command and wait for the reply
+	@param command command line without newline, e.g. "cursor 1 0"
+	@return reply without newline, "OK" or "ERR reason", empty if the daemon has gone
+*/
+std::string HD44780DaemonClient::ClientCommand(const std::string &command)
+{
+	if (_Socket < 0) return "";
+	std::string line = command + "\n";
+	if (send(_Socket, line.data(), line.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(line.size())) return "";
+	std::string reply;
+	char next;
+	while (recv(_Socket, &next, 1, 0) == 1)
+	{
+		if (next == '\n') return reply;
+		reply += next;
+	}
+	return "";
+}
+
+// **** EOF ****
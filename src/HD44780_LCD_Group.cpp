@@ -0,0 +1,272 @@
+/*!
+	@file     HD44780_LCD_Group.cpp
+	@author   Gavin Lyons
+	@brief    Display group for HD44780_LCD library, many PCF8574 backpacks on one I2C bus.
+	@details  URL: https://github.com/gavinlyonsrepo/HD44780_LCD_RPI
+*/
+
+// Section : Includes
+#include "HD44780_LCD_Group.hpp"
+
+/*!
+	@brief Constructor for class HD44780LCDGroup
+	@param bus the real bus transport, e.g. HD44780TransportBCM2835, must outlive the group
+	@param schedule GroupRoundRobin or GroupDeadline
+	@details Construct each display with the group as its transport then GroupAdd it.
+*/
+HD44780LCDGroup::HD44780LCDGroup(HD44780Transport &bus, GroupSchedule_e schedule) : _Bus(bus)
+{
+	_Schedule = schedule;
+	_StatsStart = std::chrono::steady_clock::now();
+}
+
+// Section : Transport methods
+
+/*!
+	@brief Start I2C operations on the bus, once for the whole group
+	@return false for failure to switch on.
+*/
+bool HD44780LCDGroup::I2CBegin(void)
+{
+	_CurrentAddress = -1;
+	return _Bus.I2CBegin();
+}
+
+/*!
+	@brief End I2C operations on the bus
+*/
+void HD44780LCDGroup::I2CEnd(void) { _Bus.I2CEnd();}
+
+/*!
+	@brief Set bus speed
+	@param speed 0 = 100K baudrate, > 0 BCM2835_I2C_CLOCK_DIVIDER value
+*/
+void HD44780LCDGroup::I2CSpeedSet(uint16_t speed) { _Bus.I2CSpeedSet(speed);}
+
+/*!
+	@brief Set slave address, only passed to the bus when it changes
+	@param address I2C address
+*/
+void HD44780LCDGroup::I2CAddressSet(uint8_t address)
+{
+	if (address == _CurrentAddress) return;
+	_Bus.I2CAddressSet(address);
+	_CurrentAddress = address;
+	_Stats.AddressSwitches++;
+}
+
+/*!
+	@brief Write to the current display and count it
+	@param buffer bytes to write
+	@param length number of bytes
+	@return bcm2835I2CReasonCodes , BCM2835_I2C_REASON_OK 0x00 = Success
+*/
+uint8_t HD44780LCDGroup::I2CWrite(const char *buffer, uint32_t length)
+{
+	_Stats.Transactions++;
+	_Stats.BytesWritten += length;
+	int8_t index = GroupIndexOf(_CurrentAddress);
+	if (index >= 0)
+	{
+		_Entries[index].Stats.Transactions++;
+		_Entries[index].Stats.BytesWritten += length;
+	}
+	return _Bus.I2CWrite(buffer, length);
+}
+
+/*!
+	@brief Read from the current display
+	@param buffer buffer to hold read bytes
+	@param length number of bytes
+	@return bcm2835I2CReasonCodes , BCM2835_I2C_REASON_OK 0x00 = Success
+*/
+uint8_t HD44780LCDGroup::I2CRead(char *buffer, uint32_t length)
+{
+	_Stats.Transactions++;
+	return _Bus.I2CRead(buffer, length);
+}
+
+/*!
+	@brief Delay in milliseconds
+	@param ms delay
+*/
+void HD44780LCDGroup::DelayMs(uint32_t ms) { _Bus.DelayMs(ms);}
+
+/*!
+	@brief Delay in microseconds
+	@param us delay
+*/
+void HD44780LCDGroup::DelayUs(uint32_t us) { _Bus.DelayUs(us);}
+
+// Section : Scheduling
+
+/*!
+	@brief Add a display to the group
+	@param display LCD constructed with this group as its transport, must outlive the group
+	@param periodMs GroupDeadline only, min time between flushes, 0 = flush whenever dirty
+	@return false if group full or address already in group
+*/
+bool HD44780LCDGroup::GroupAdd(HD44780PCF8574LCD &display, uint32_t periodMs)
+{
+	if (_NumDisplays >= GROUP_MAX_DISPLAYS) return false;
+	if (GroupIndexOf(display.LCDI2CAddressGet()) >= 0) return false;
+	GroupEntry &entry = _Entries[_NumDisplays++];
+	entry.Display = &display;
+	entry.PeriodUs = periodMs * 1000;
+	entry.DeadlineUs = GroupNowUs();
+	entry.Stats = HD44780GroupDisplayStats();
+	entry.Stats.Address = display.LCDI2CAddressGet();
+	return true;
+}
+
+/*!
+	@brief Flush the displays with dirty shadow cells, in the group schedule order
+	@param maxDisplays max number of displays to flush in this call, bounds the time taken
+	@return number of displays flushed
+*/
+uint8_t HD44780LCDGroup::GroupFlush(uint8_t maxDisplays)
+{
+	uint8_t flushed = 0;
+
+	if (_Schedule == GroupRoundRobin)
+	{
+		for (uint8_t i = 0; i < _NumDisplays && flushed < maxDisplays; i++)
+		{
+			uint8_t index = (_NextRoundRobin + i) % _NumDisplays;
+			if (GroupFlushOne(index) == false) continue;
+			flushed++;
+			_NextRoundRobin = (index + 1) % _NumDisplays;
+		}
+		return flushed;
+	}
+
+	// Deadline order, collect displays that are due and sort by deadline
+	uint64_t now = GroupNowUs();
+	uint8_t due[GROUP_MAX_DISPLAYS];
+	uint8_t numDue = 0;
+	for (uint8_t index = 0; index < _NumDisplays; index++)
+	{
+		GroupEntry &entry = _Entries[index];
+		if (entry.DeadlineUs > now) continue;
+		if (entry.Display->LCDShadowDirtyGet() == false)
+		{
+			entry.DeadlineUs = now; // nothing to do, keep due without counting lateness
+			continue;
+		}
+		uint8_t pos = numDue++;
+		while (pos > 0 && _Entries[due[pos - 1]].DeadlineUs > entry.DeadlineUs)
+		{
+			due[pos] = due[pos - 1];
+			pos--;
+		}
+		due[pos] = index;
+	}
+	for (uint8_t i = 0; i < numDue && flushed < maxDisplays; i++)
+	{
+		GroupEntry &entry = _Entries[due[i]];
+		uint64_t start = GroupNowUs();
+		uint32_t lateness = start - entry.DeadlineUs;
+		if (lateness > entry.Stats.MaxLatenessUs) entry.Stats.MaxLatenessUs = lateness;
+		GroupFlushOne(due[i]);
+		entry.DeadlineUs = start + entry.PeriodUs;
+		flushed++;
+	}
+	return flushed;
+}
+
+/*!
+	@brief Flush one display if it is dirty, and time it
+	@param index display index
+	@return true if flushed
+*/
+bool HD44780LCDGroup::GroupFlushOne(uint8_t index)
+{
+	GroupEntry &entry = _Entries[index];
+	if (entry.Display->LCDShadowDirtyGet() == false) return false;
+
+	uint64_t start = GroupNowUs();
+	entry.Display->flush();
+	uint32_t latency = GroupNowUs() - start;
+
+	entry.Stats.Flushes++;
+	entry.Stats.LastLatencyUs = latency;
+	entry.Stats.TotalLatencyUs += latency;
+	if (latency > entry.Stats.MaxLatencyUs) entry.Stats.MaxLatencyUs = latency;
+	return true;
+}
+
+/*!
+	@brief Forget the slave address set on the bus
+	@note Call if something outside the group used the bus.
+*/
+void HD44780LCDGroup::GroupAddressInvalidate(void) { _CurrentAddress = -1;}
+
+/*!
+	@brief Get the number of displays in the group
+	@return number of displays
+*/
+uint8_t HD44780LCDGroup::GroupSizeGet(void) { return _NumDisplays;}
+
+/*!
+	@brief Get the bus counters and aggregate throughput
+	@return copy of the counters
+*/
+HD44780GroupStats HD44780LCDGroup::GroupStatsGet(void)
+{
+	HD44780GroupStats stats = _Stats;
+	stats.ElapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - _StatsStart).count();
+	if (stats.ElapsedUs > 0)
+		stats.BytesPerSecond = stats.BytesWritten * 1000000.0 / stats.ElapsedUs;
+	return stats;
+}
+
+/*!
+	@brief Get the counters of one display
+	@param index display index, order of GroupAdd
+	@return copy of the counters
+*/
+HD44780GroupDisplayStats HD44780LCDGroup::GroupDisplayStatsGet(uint8_t index)
+{
+	if (index >= _NumDisplays) return HD44780GroupDisplayStats();
+	return _Entries[index].Stats;
+}
+
+/*!
+	@brief Zero the bus and display counters and restart the throughput window
+*/
+void HD44780LCDGroup::GroupStatsReset(void)
+{
+	_Stats = HD44780GroupStats();
+	for (uint8_t index = 0; index < _NumDisplays; index++)
+	{
+		uint8_t address = _Entries[index].Stats.Address;
+		_Entries[index].Stats = HD44780GroupDisplayStats();
+		_Entries[index].Stats.Address = address;
+	}
+	_StatsStart = std::chrono::steady_clock::now();
+}
+
+/*!
+	@brief Find a display by I2C address
+	@param address I2C address
+	@return display index, -1 if not in group
+*/
+int8_t HD44780LCDGroup::GroupIndexOf(int16_t address)
+{
+	for (uint8_t index = 0; index < _NumDisplays; index++)
+		if (_Entries[index].Stats.Address == address) return index;
+	return -1;
+}
+
+/*!
+	@brief Monotonic time
+	@return uS since steady clock epoch
+*/
+uint64_t HD44780LCDGroup::GroupNowUs(void)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// **** EOF ****
@@ -49,12 +49,10 @@ size_t Print::print(long n, int base)
   if (base == 0) {
     return write(n);
   } else if (base == 10) {
-    if (n < 0) {
-      int t = print('-');
-      n = -n;
-      return printNumber(n, 10) + t;
-    }
-    return printNumber(n, 10);
+    // sign and digits formatted together, one call to the sink
+    char buf[8 * sizeof(long) + 2];
+    char *end = std::to_chars(buf, buf + sizeof(buf), n).ptr;
+    return write(buf, end - buf);
   } else {
     return printNumber(n, base);
   }
@@ -74,30 +72,39 @@ size_t Print::print(double n, int digits)
 
 // Private Methods 
 
+// Digits into a stack buffer, handed to the sink in one write
 size_t Print::printNumber(unsigned long n, uint8_t base)
 {
   char buf[8 * sizeof(long) + 1]; // Assumes 8-bit chars plus zero byte.
-  char *str = &buf[sizeof(buf) - 1];
-
-  *str = '\0';
 
   // prevent crash if called with base == 1
   if (base < 2) base = 10;
 
-  do {
-    char c = n % base;
-    n /= base;
-
-    *--str = c < 10 ? c + '0' : c + 'A' - 10;
-  } while(n);
+  if (base > 36) {
+    char *str = &buf[sizeof(buf)];
+    do {
+      char c = n % base;
+      n /= base;
+      *--str = c < 10 ? c + '0' : c + 'A' - 10;
+    } while(n);
+    return write(str, &buf[sizeof(buf)] - str);
+  }
 
-  return write(str);
+  char *end = std::to_chars(buf, buf + sizeof(buf), n, base).ptr;
+  for (char *c = buf; c < end; c++) {
+    if (*c >= 'a') *c -= 'a' - 'A'; // upper case hex, as Arduino
+  }
+  return write(buf, end - buf);
 }
 
+// Sign, integer part, point and fraction digits built in a stack buffer, 
+// handed to the sink in one write. The Arduino rounding arithmetic is kept 
+// so the digits are the same as before.
 size_t Print::printFloat(double number, uint8_t digits) 
 { 
-  size_t n = 0;
-  
+  char buf[1 + 8 * sizeof(long) + 1 + UINT8_MAX]; // sign, integer part, point, digits
+  char *str = buf;
+
   if (std::isnan(number)) return print("nan");
   if (std::isinf(number)) return print("inf");
   if (number > 4294967040.0) return print ("ovf");  // constant determined empirically
@@ -106,7 +113,7 @@ size_t Print::printFloat(double number, uint8_t digits)
   // Handle negative numbers
   if (number < 0.0)
   {
-     n += print('-');
+     *str++ = '-';
      number = -number;
   }
 
@@ -117,14 +124,14 @@ size_t Print::printFloat(double number, uint8_t digits)
   
   number += rounding;
 
-  // Extract the integer part of the number and print it
+  // Extract the integer part of the number
   unsigned long int_part = (unsigned long)number;
   double remainder = number - (double)int_part;
-  n += print(int_part);
+  str = std::to_chars(str, buf + sizeof(buf), int_part).ptr;
 
-  // Print the decimal point, but only if there are digits beyond
+  // The decimal point, but only if there are digits beyond
   if (digits > 0) {
-    n += print('.'); 
+    *str++ = '.'; 
   }
 
   // Extract digits from the remainder one at a time
@@ -132,9 +139,9 @@ size_t Print::printFloat(double number, uint8_t digits)
   {
     remainder *= 10.0;
     unsigned int toPrint = (unsigned int)(remainder);
-    n += print(toPrint);
+    *str++ = '0' + toPrint;
     remainder -= toPrint; 
   } 
   
-  return n;
+  return write(buf, str - buf);
 }
@@ -0,0 +1,500 @@
+/*!
+	@file     HD44780_LCD_Sim.cpp
+	@author   Gavin Lyons
+	@brief    Simulated bus transport for HD44780_LCD library, software PCF8574 + HD44780
+	@details  URL: https://github.com/gavinlyonsrepo/HD44780_LCD_RPI
+*/
+
+// Section : Includes
+#include <cstring>
+#include "HD44780_LCD_Sim.hpp"
+
+/*!
+	@brief Constructor for class HD44780TransportSim
+	@param NumRow number of rows in LCD
+	@param NumCol number of columns in LCD
+	@param I2Caddress The I2C address the simulated PCF8574 answers on, default is 0x27.
+*/
+HD44780TransportSim::HD44780TransportSim(uint8_t NumRow, uint8_t NumCol, uint8_t I2Caddress)
+{
+	_NumRowsLCD = NumRow;
+	_NumColsLCD = NumCol;
+	_SimAddressI2C = I2Caddress;
+	_TargetAddressI2C = I2Caddress;
+	SimPowerOnReset();
+}
+
+// Section : Transport methods
+
+/*!
+	@brief Start I2C operations, always succeeds
+	@return true
+*/
+bool HD44780TransportSim::I2CBegin(void) { return true;}
+
+/*!
+	@brief End I2C operations, does nothing
+*/
+void HD44780TransportSim::I2CEnd(void) {}
+
+/*!
+	@brief Set the modelled I2C bus speed
+	@param speed 0 = 100K baudrate, > 0 BCM2835_I2C_CLOCK_DIVIDER value
+*/
+void HD44780TransportSim::I2CSpeedSet(uint16_t speed) { _SimSpeedI2C = speed;}
+
+/*!
+	@brief Set I2C slave address for following transfers
+	@param address I2C address, transfers to any other address than the simulated PCF8574 are NACKed
+*/
+void HD44780TransportSim::I2CAddressSet(uint8_t address) { _TargetAddressI2C = address;}
+
+/*!
+	@brief Write a buffer to the simulated PCF8574, each byte updates the pin latch
+	@param buffer bytes to write
+	@param length number of bytes
+	@return bcm2835I2CReasonCodes , BCM2835_I2C_REASON_ERROR_NACK if not connected
+*/
+uint8_t HD44780TransportSim::I2CWrite(const char *buffer, uint32_t length)
+{
+	_Stats.Transactions++;
+	SimClock(10 * SimBitTimeUs()); // start + address + ack
+	if (_SimConnected == false || _TargetAddressI2C != _SimAddressI2C)
+	{
+		SimClock(SimBitTimeUs()); // stop
+		return BCM2835_I2C_REASON_ERROR_NACK;
+	}
+	for (uint32_t i = 0; i < length; i++)
+	{
+		SimClock(9 * SimBitTimeUs());
+		SimLatch(static_cast<uint8_t>(buffer[i]));
+		_Stats.BytesWritten++;
+	}
+	SimClock(SimBitTimeUs()); // stop
+	return BCM2835_I2C_REASON_OK;
+}
+
+/*!
+	@brief Read the simulated PCF8574 pins
+	@param buffer buffer to hold read bytes
+	@param length number of bytes
+	@return bcm2835I2CReasonCodes , BCM2835_I2C_REASON_ERROR_NACK if not connected
+	@note D7-D4 read the HD44780 output while RW and EN are high, otherwise the latch.
+*/
+uint8_t HD44780TransportSim::I2CRead(char *buffer, uint32_t length)
+{
+	_Stats.Transactions++;
+	SimClock(10 * SimBitTimeUs());
+	if (_SimConnected == false || _TargetAddressI2C != _SimAddressI2C)
+	{
+		SimClock(SimBitTimeUs());
+		return BCM2835_I2C_REASON_ERROR_NACK;
+	}
+	for (uint32_t i = 0; i < length; i++)
+	{
+		SimClock(9 * SimBitTimeUs());
+		uint8_t pins = _Pins;
+		if (_SimReadWired && (_Pins & SimPinRW) && (_Pins & SimPinEN))
+			pins = (_Pins & 0x0F) | (_Pins & _ReadNibbles & 0xF0);
+		buffer[i] = static_cast<char>(pins);
+		_Stats.BytesRead++;
+	}
+	SimClock(SimBitTimeUs());
+	return BCM2835_I2C_REASON_OK;
+}
+
+/*!
+	@brief Advance the virtual clock, returns at once
+	@param ms delay
+*/
+void HD44780TransportSim::DelayMs(uint32_t ms)
+{
+	_Stats.DelayTimeUs += ms * 1000.0;
+	_TimeUs += ms * 1000.0;
+}
+
+/*!
+	@brief Advance the virtual clock, returns at once
+	@param us delay
+*/
+void HD44780TransportSim::DelayUs(uint32_t us)
+{
+	_Stats.DelayTimeUs += us;
+	_TimeUs += us;
+}
+
+// Section : Emulation
+
+/*!
+	@brief Update the PCF8574 latch and clock the HD44780 on enable edges
+	@param pins new latch value DATA-led-en-rw-rs
+*/
+void HD44780TransportSim::SimLatch(uint8_t pins)
+{
+	uint8_t previous = _Pins;
+	_Pins = pins;
+	bool rs = (previous & SimPinRS);
+
+	// Rising edge of EN on a read, HD44780 drives the data lines
+	if (!(previous & SimPinEN) && (pins & SimPinEN) && (pins & SimPinRW))
+	{
+		uint8_t value = SimReadByte(pins & SimPinRS);
+		if (_EightBitMode == true || _ReadPhase == 0)
+			_ReadNibbles = value & 0xF0;
+		else
+			_ReadNibbles = (value << 4) & 0xF0;
+		return;
+	}
+
+	// Falling edge of EN, transfer is latched
+	if (!(previous & SimPinEN) || (pins & SimPinEN)) return;
+
+	if (previous & SimPinRW)
+	{
+		if (_EightBitMode == true || ++_ReadPhase == 2)
+		{
+			_ReadPhase = 0;
+			SimReadDone(rs);
+		}
+		return;
+	}
+
+	uint8_t nibble = previous & 0xF0;
+	if (_EightBitMode == true)
+	{
+		SimExecute(nibble, rs); // DB3-DB0 not connected on the backpack
+	}
+	else if (_NibblePending == false)
+	{
+		_NibbleUpper = nibble;
+		_NibblePending = true;
+	}
+	else
+	{
+		_NibblePending = false;
+		SimExecute(_NibbleUpper | (nibble >> 4), rs);
+	}
+}
+
+/*!
+	@brief Execute an instruction or a data write on the HD44780
+	@param byte instruction or data byte
+	@param rs register select, true = data
+*/
+void HD44780TransportSim::SimExecute(uint8_t byte, bool rs)
+{
+	const double ExecTimeUs = 37; // datasheet, most instructions
+	const double ExecTimeLongUs = 1520; // datasheet, clear and home
+	const uint8_t ringSize = _TwoLine ? 40 : 80;
+	double execTime = ExecTimeUs;
+
+	if (_TimeUs < _BusyUntilUs) _Stats.BusyViolations++;
+	if (_ExecuteHook) _ExecuteHook(byte, rs);
+
+	if (rs)
+	{
+		_Stats.DataWrites++;
+		if (_AddressCGRAM == true)
+			_CGRAM[_AddressCounter & 0x3F] = byte;
+		else
+			_DDRAM[_AddressCounter & 0x7F] = byte;
+		_AddressCounter = SimAddressStep(_AddressCounter, _EntryIncrement);
+		if (_EntryShift == true && _AddressCGRAM == false)
+			_DisplayShift = _EntryIncrement ? (_DisplayShift + 1) % ringSize : (_DisplayShift + ringSize - 1) % ringSize;
+		_BusyUntilUs = _TimeUs + ExecTimeUs;
+		return;
+	}
+
+	_Stats.Commands++;
+	if (byte & 0x80) // Set DDRAM address
+	{
+		_AddressCounter = byte & 0x7F;
+		_AddressCGRAM = false;
+	}
+	else if (byte & 0x40) // Set CGRAM address
+	{
+		_AddressCounter = byte & 0x3F;
+		_AddressCGRAM = true;
+	}
+	else if (byte & 0x20) // Function set
+	{
+		_EightBitMode = (byte & 0x10);
+		_TwoLine = (byte & 0x08);
+		_NibblePending = false;
+		_ReadPhase = 0;
+	}
+	else if (byte & 0x10) // Cursor or display shift
+	{
+		bool right = (byte & 0x04);
+		if (byte & 0x08)
+			_DisplayShift = right ? (_DisplayShift + ringSize - 1) % ringSize : (_DisplayShift + 1) % ringSize;
+		else
+			_AddressCounter = SimAddressStep(_AddressCounter, right);
+	}
+	else if (byte & 0x08) // Display control
+	{
+		_DisplayControl = byte & 0x0F;
+	}
+	else if (byte & 0x04) // Entry mode set
+	{
+		_EntryIncrement = (byte & 0x02);
+		_EntryShift = (byte & 0x01);
+	}
+	else if (byte & 0x02) // Return home
+	{
+		_AddressCounter = 0;
+		_AddressCGRAM = false;
+		_DisplayShift = 0;
+		execTime = ExecTimeLongUs;
+	}
+	else if (byte & 0x01) // Clear display
+	{
+		memset(_DDRAM, ' ', sizeof(_DDRAM));
+		_AddressCounter = 0;
+		_AddressCGRAM = false;
+		_EntryIncrement = true;
+		_DisplayShift = 0;
+		execTime = ExecTimeLongUs;
+	}
+	_BusyUntilUs = _TimeUs + execTime;
+}
+
+/*!
+	@brief Value the HD44780 outputs for a read
+	@param rs register select, false = busy flag and address counter, true = RAM data
+	@return byte
+*/
+uint8_t HD44780TransportSim::SimReadByte(bool rs)
+{
+	if (rs == false)
+		return ((_TimeUs < _BusyUntilUs) ? 0x80 : 0x00) | (_AddressCounter & 0x7F);
+	if (_AddressCGRAM == true)
+		return _CGRAM[_AddressCounter & 0x3F];
+	return _DDRAM[_AddressCounter & 0x7F];
+}
+
+/*!
+	@brief A read completed, RAM data reads advance the address counter
+	@param rs register select
+*/
+void HD44780TransportSim::SimReadDone(bool rs)
+{
+	_Stats.DataReads++;
+	if (rs) _AddressCounter = SimAddressStep(_AddressCounter, _EntryIncrement);
+}
+
+/*!
+	@brief Next address counter value, with the HD44780 DDRAM line wrap
+	@param address current address
+	@param increment true = increment, false = decrement
+	@return new address
+*/
+uint8_t HD44780TransportSim::SimAddressStep(uint8_t address, bool increment)
+{
+	if (_AddressCGRAM == true)
+		return (address + (increment ? 1 : -1)) & 0x3F;
+	if (_TwoLine == false)
+		return increment ? (address + 1) % 0x50 : (address == 0 ? 0x4F : address - 1);
+	if (increment)
+	{
+		if (address == 0x27) return 0x40;
+		if (address == 0x67) return 0x00;
+		return address + 1;
+	}
+	if (address == 0x00) return 0x67;
+	if (address == 0x40) return 0x27;
+	return address - 1;
+}
+
+/*!
+	@brief DDRAM address shown in a visible cell, allowing for display shift
+	@param row row 0-3
+	@param col column
+	@return DDRAM address
+*/
+uint8_t HD44780TransportSim::SimCellAddress(uint8_t row, uint8_t col)
+{
+	if (_TwoLine == false)
+		return (col + _DisplayShift) % 0x50;
+
+	uint8_t line = (row & 1) ? 0x40 : 0x00;
+	uint8_t offset = (row >= 2) ? _NumColsLCD : 0;
+	if (_NumRowsLCD == 1 && _NumColsLCD == 16 && col >= 8) // 16x1 split addressing
+	{
+		line = 0x40;
+		col -= 8;
+	}
+	return line + ((offset + col + _DisplayShift) % 40);
+}
+
+/*!
+	@brief Advance the virtual clock
+	@param us time in uS
+*/
+void HD44780TransportSim::SimClock(double us)
+{
+	_TimeUs += us;
+	_Stats.BusTimeUs += us;
+}
+
+/*!
+	@brief Time of one I2C bit at the configured speed
+	@return bit time in uS
+	@note Clock divider is based on nominal base clock rate of 250MHz
+*/
+double HD44780TransportSim::SimBitTimeUs(void)
+{
+	if (_SimSpeedI2C == 0) return 10.0; // 100K
+	return _SimSpeedI2C / 250.0;
+}
+
+// Section : Inspection
+
+/*!
+	@brief Visible contents of one line, allowing for display shift
+	@param lineNo row 1-4
+	@return NumCol raw character codes, custom characters are 0x00-0x07
+*/
+std::string HD44780TransportSim::SimLineGet(uint8_t lineNo)
+{
+	std::string line;
+	if (lineNo < 1 || lineNo > _NumRowsLCD) return line;
+	for (uint8_t col = 0; col < _NumColsLCD; col++)
+		line += static_cast<char>(_DDRAM[SimCellAddress(lineNo - 1, col)]);
+	return line;
+}
+
+/*!
+	@brief Visible contents of the whole display
+	@return every line, separated by newline
+*/
+std::string HD44780TransportSim::SimScreenGet(void)
+{
+	std::string screen;
+	for (uint8_t lineNo = 1; lineNo <= _NumRowsLCD; lineNo++)
+	{
+		screen += SimLineGet(lineNo);
+		if (lineNo < _NumRowsLCD) screen += '\n';
+	}
+	return screen;
+}
+
+/*!
+	@brief Read the emulated display data RAM
+	@param address DDRAM address 0x00-0x7F
+	@return data byte
+*/
+uint8_t HD44780TransportSim::SimDDRAMGet(uint8_t address) { return _DDRAM[address & 0x7F];}
+
+/*!
+	@brief Read the emulated character generator RAM
+	@param address CGRAM address 0x00-0x3F
+	@return data byte
+*/
+uint8_t HD44780TransportSim::SimCGRAMGet(uint8_t address) { return _CGRAM[address & 0x3F];}
+
+/*!
+	@brief Get the emulated address counter
+	@return address counter
+*/
+uint8_t HD44780TransportSim::SimAddressCounterGet(void) { return _AddressCounter;}
+
+/*!
+	@brief Get the emulated display shift
+	@return DDRAM column shown in visible column 0
+*/
+uint8_t HD44780TransportSim::SimDisplayShiftGet(void) { return _DisplayShift;}
+
+/*!
+	@brief Get the emulated entry mode
+	@return entry mode command byte 0x04-0x07
+*/
+uint8_t HD44780TransportSim::SimEntryModeGet(void)
+{
+	return 0x04 | (_EntryIncrement ? 0x02 : 0x00) | (_EntryShift ? 0x01 : 0x00);
+}
+
+/*!
+	@brief Get the emulated display control, display cursor and blink
+	@return display control command byte 0x08-0x0F
+*/
+uint8_t HD44780TransportSim::SimDisplayControlGet(void) { return 0x08 | _DisplayControl;}
+
+/*!
+	@brief Get the emulated interface data length
+	@return true if in 4-bit mode
+*/
+bool HD44780TransportSim::SimFourBitModeGet(void) { return !_EightBitMode;}
+
+/*!
+	@brief Get the backlight pin of the emulated PCF8574
+	@return true if backlight on
+*/
+bool HD44780TransportSim::SimBackLightGet(void) { return (_Pins & SimPinLED);}
+
+/*!
+	@brief Get the virtual clock
+	@return time in uS since construction, bus time plus delays
+*/
+double HD44780TransportSim::SimTimeUsGet(void) { return _TimeUs;}
+
+// Section : Fault injection and counters
+
+/*!
+	@brief Connect or disconnect the simulated device
+	@param OnOff false = every transfer is NACKed
+*/
+void HD44780TransportSim::SimConnectedSet(bool OnOff) { _SimConnected = OnOff;}
+
+/*!
+	@brief Model a backpack with the HD44780 RW pin tied to ground
+	@param OnOff false = reads return the PCF8574 latch, the busy flag never clears
+*/
+void HD44780TransportSim::SimReadWiredSet(bool OnOff) { _SimReadWired = OnOff;}
+
+/*!
+	@brief Set a function called with every byte the emulated HD44780 receives
+	@param hook called with the byte and true for data(RS high) or false for a command,
+		before it is executed. Pass nullptr to remove.
+	@note Used by the TRACE_REPLAY example to print the decoded command stream.
+*/
+void HD44780TransportSim::SimExecuteHookSet(std::function<void(uint8_t value, bool data)> hook)
+{
+	_ExecuteHook = hook;
+}
+
+/*!
+	@brief Put the emulated controller and PCF8574 in their power on state
+	@details 8-bit interface, one line, display off, DDRAM cleared, CGRAM zeroed.
+		The bus counters and the virtual clock are kept.
+*/
+void HD44780TransportSim::SimPowerOnReset(void)
+{
+	memset(_DDRAM, ' ', sizeof(_DDRAM));
+	memset(_CGRAM, 0x00, sizeof(_CGRAM));
+	_Pins = 0xFF;
+	_EightBitMode = true;
+	_NibblePending = false;
+	_ReadPhase = 0;
+	_AddressCounter = 0;
+	_AddressCGRAM = false;
+	_EntryIncrement = true;
+	_EntryShift = false;
+	_DisplayShift = 0;
+	_DisplayControl = 0x00;
+	_TwoLine = false;
+	_BusyUntilUs = 0;
+}
+
+/*!
+	@brief Get the bus and controller counters
+	@return copy of the counters
+*/
+HD44780SimStats HD44780TransportSim::SimStatsGet(void) { return _Stats;}
+
+/*!
+	@brief Zero the bus and controller counters
+*/
+void HD44780TransportSim::SimStatsReset(void) { _Stats = HD44780SimStats();}
+
+// **** EOF ****
@@ -0,0 +1,302 @@
+/*!
+	@file     HD44780_LCD_Trace.cpp
+	@author   Gavin Lyons
+	@brief    Bus trace capture and read back for HD44780_LCD library.
+	@details  URL: https://github.com/gavinlyonsrepo/HD44780_LCD_RPI
+*/
+
+// Section : Includes
+#include <cstring>
+#include "HD44780_LCD_Trace.hpp"
+
+// Section : Defines
+static const char HD44780TraceMagic[4] = {'H', 'D', '4', 'T'}; // file header
+static const uint8_t HD44780TraceVersion = 1;
+static const uint64_t HD44780TraceBytesMax = 4096; // longest write or read read back, library writes are 320 at most
+
+// Section : HD44780TransportRecord
+
+/*!
+	@brief Constructor for class HD44780TransportRecord
+	@param inner transport the transfers are passed to, must outlive this object
+*/
+HD44780TransportRecord::HD44780TransportRecord(HD44780Transport &inner) : _Inner(inner) {}
+
+/*!
+	@brief Destructor, closes the trace file
+*/
+HD44780TransportRecord::~HD44780TransportRecord() { RecordClose();}
+
+/*!
+	@brief Start I2C operations on the inner transport
+	@return false for failure to switch on.
+*/
+bool HD44780TransportRecord::I2CBegin(void)
+{
+	bool result = _Inner.I2CBegin();
+	RecordHeader(HD44780TraceBegin);
+	if (RecordGet() == true) _File.put(result ? 1 : 0);
+	return result;
+}
+
+/*!
+	@brief End I2C operations on the inner transport
+*/
+void HD44780TransportRecord::I2CEnd(void)
+{
+	_Inner.I2CEnd();
+	RecordHeader(HD44780TraceEnd);
+}
+
+/*!
+	@brief Set bus speed
+	@param speed 0 = 100K baudrate, > 0 BCM2835_I2C_CLOCK_DIVIDER value
+*/
+void HD44780TransportRecord::I2CSpeedSet(uint16_t speed)
+{
+	_Inner.I2CSpeedSet(speed);
+	RecordHeader(HD44780TraceSpeed);
+	if (RecordGet() == false) return;
+	_File.put(speed & 0xFF);
+	_File.put(speed >> 8);
+}
+
+/*!
+	@brief Set slave address
+	@param address I2C address
+*/
+void HD44780TransportRecord::I2CAddressSet(uint8_t address)
+{
+	_Inner.I2CAddressSet(address);
+	RecordHeader(HD44780TraceAddress);
+	if (RecordGet() == true) _File.put(address);
+}
+
+/*!
+	@brief Write to the inner transport and record the frames
+	@param buffer bytes to write
+	@param length number of bytes
+	@return bcm2835I2CReasonCodes , BCM2835_I2C_REASON_OK 0x00 = Success
+*/
+uint8_t HD44780TransportRecord::I2CWrite(const char *buffer, uint32_t length)
+{
+	uint8_t result = _Inner.I2CWrite(buffer, length);
+	RecordHeader(HD44780TraceWrite);
+	RecordBytes(buffer, length, result);
+	return result;
+}
+
+/*!
+	@brief Read from the inner transport and record the bytes read
+	@param buffer buffer to hold read bytes
+	@param length number of bytes
+	@return bcm2835I2CReasonCodes , BCM2835_I2C_REASON_OK 0x00 = Success
+*/
+uint8_t HD44780TransportRecord::I2CRead(char *buffer, uint32_t length)
+{
+	uint8_t result = _Inner.I2CRead(buffer, length);
+	RecordHeader(HD44780TraceRead);
+	RecordBytes(buffer, length, result);
+	return result;
+}
+
+/*!
+	@brief Delay in milliseconds, recorded in uS
+	@param ms delay
+*/
+void HD44780TransportRecord::DelayMs(uint32_t ms)
+{
+	RecordHeader(HD44780TraceDelay);
+	RecordVarint(static_cast<uint64_t>(ms) * 1000);
+	_Inner.DelayMs(ms);
+}
+
+/*!
+	@brief Delay in microseconds
+	@param us delay
+*/
+void HD44780TransportRecord::DelayUs(uint32_t us)
+{
+	RecordHeader(HD44780TraceDelay);
+	RecordVarint(us);
+	_Inner.DelayUs(us);
+}
+
+/*!
+	@brief Start recording to a file, replaced if it exists
+	@param path trace file path
+	@return false if the file can not be opened
+*/
+bool HD44780TransportRecord::RecordOpen(const std::string &path)
+{
+	RecordClose();
+	_File.open(path, std::ios::binary | std::ios::trunc);
+	if (!_File) return false;
+	_File.write(HD44780TraceMagic, sizeof(HD44780TraceMagic));
+	_File.put(HD44780TraceVersion);
+	_Start = std::chrono::steady_clock::now();
+	_LastUs = 0;
+	_Count = 0;
+	return true;
+}
+
+/*!
+	@brief Stop recording and close the file
+*/
+void HD44780TransportRecord::RecordClose(void)
+{
+	if (_File.is_open()) _File.close();
+}
+
+/*!
+	@brief Check if recording
+	@return true if a trace file is open
+*/
+bool HD44780TransportRecord::RecordGet(void) { return _File.is_open();}
+
+/*!
+	@brief Get the number of records written since RecordOpen
+	@return record count
+*/
+uint32_t HD44780TransportRecord::RecordCountGet(void) { return _Count;}
+
+/*!
+	@brief Write the type and time of a record
+	@param type record type
+*/
+void HD44780TransportRecord::RecordHeader(HD44780TraceType_e type)
+{
+	if (RecordGet() == false) return;
+	uint64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - _Start).count();
+	_File.put(type);
+	RecordVarint(now - _LastUs);
+	_LastUs = now;
+	_Count++;
+}
+
+/*!
+	@brief Write an unsigned LEB128 varint, 7 bits per byte, low bits first
+	@param value number to write
+*/
+void HD44780TransportRecord::RecordVarint(uint64_t value)
+{
+	if (RecordGet() == false) return;
+	while (value >= 0x80)
+	{
+		_File.put(static_cast<char>(0x80 | (value & 0x7F)));
+		value >>= 7;
+	}
+	_File.put(static_cast<char>(value));
+}
+
+/*!
+	@brief Write the payload of a write or read record
+	@param buffer bytes
+	@param length number of bytes
+	@param result bcm2835I2CReasonCodes of the transfer
+*/
+void HD44780TransportRecord::RecordBytes(const char *buffer, uint32_t length, uint8_t result)
+{
+	if (RecordGet() == false) return;
+	RecordVarint(length);
+	_File.write(buffer, length);
+	_File.put(result);
+}
+
+// Section : HD44780TraceReader
+
+/*!
+	@brief Open a trace file and check its header
+	@param path trace file path
+	@return false if the file can not be opened or is not a version 1 trace
+*/
+bool HD44780TraceReader::TraceOpen(const std::string &path)
+{
+	TraceClose();
+	_File.open(path, std::ios::binary);
+	char header[sizeof(HD44780TraceMagic) + 1];
+	if (!_File.read(header, sizeof(header))) return false;
+	_TimeUs = 0;
+	return memcmp(header, HD44780TraceMagic, sizeof(HD44780TraceMagic)) == 0
+		&& static_cast<uint8_t>(header[sizeof(HD44780TraceMagic)]) == HD44780TraceVersion;
+}
+
+/*!
+	@brief Read the next record
+	@param record filled in
+	@return false at end of file or on a truncated, unknown or corrupt record,
+		e.g. a transfer longer than 4096 bytes
+*/
+bool HD44780TraceReader::TraceNext(HD44780TraceRecord &record)
+{
+	int type = _File.get();
+	uint64_t delta = 0;
+	if (type == EOF || TraceVarint(delta) == false) return false;
+	_TimeUs += delta;
+	record.Type = static_cast<HD44780TraceType_e>(type);
+	record.TimeUs = _TimeUs;
+	record.Value = 0;
+	record.Result = 0;
+	record.Bytes.clear();
+
+	uint64_t value = 0;
+	switch (record.Type)
+	{
+		case HD44780TraceBegin:
+			record.Result = _File.get();
+		break;
+		case HD44780TraceEnd:
+		break;
+		case HD44780TraceSpeed:
+			record.Value = _File.get();
+			record.Value |= _File.get() << 8;
+		break;
+		case HD44780TraceAddress:
+			record.Value = _File.get();
+		break;
+		case HD44780TraceWrite:
+		case HD44780TraceRead:
+			if (TraceVarint(value) == false || value > HD44780TraceBytesMax) return false;
+			record.Bytes.resize(value);
+			_File.read(&record.Bytes[0], value);
+			record.Result = _File.get();
+		break;
+		case HD44780TraceDelay:
+			if (TraceVarint(value) == false) return false;
+			record.Value = value;
+		break;
+		default:
+			return false;
+	}
+	return static_cast<bool>(_File);
+}
+
+/*!
+	@brief Close the trace file
+*/
+void HD44780TraceReader::TraceClose(void)
+{
+	if (_File.is_open()) _File.close();
+	_File.clear();
+}
+
+/*!
+	@brief Read an unsigned LEB128 varint
+	@param value set to the number read
+	@return false if the file ends inside the varint
+*/
+bool HD44780TraceReader::TraceVarint(uint64_t &value)
+{
+	value = 0;
+	for (uint8_t shift = 0; shift < 64; shift += 7)
+	{
+		int byte = _File.get();
+		if (byte == EOF) return false;
+		value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) return true;
+	}
+	return false;
+}
+
+// **** EOF ****
@@ -0,0 +1,273 @@
+/*!
+	@file     HD44780_LCD_Transport.cpp
+	@author   Gavin Lyons
+	@brief    bcm2835 and Linux i2c-dev bus transports for HD44780_LCD library
+	@details  URL: https://github.com/gavinlyonsrepo/HD44780_LCD_RPI
+*/
+
+// Section : Includes
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include "HD44780_LCD_Transport.hpp"
+
+// Section : methods
+
+/*!
+	@brief Start I2C operations, see bcm2835_i2c_begin
+	@return false for failure to switch on.
+*/
+bool HD44780TransportBCM2835::I2CBegin(void) { return bcm2835_i2c_begin();}
+
+/*!
+	@brief End I2C operations, see bcm2835_i2c_end
+*/
+void HD44780TransportBCM2835::I2CEnd(void) { bcm2835_i2c_end();}
+
+/*!
+	@brief Set I2C bus speed
+	@param speed 0 = 100K baudrate, > 0 BCM2835_I2C_CLOCK_DIVIDER value
+*/
+void HD44780TransportBCM2835::I2CSpeedSet(uint16_t speed)
+{
+	const uint32_t I2CBaudRate = 100000;// 100K
+	if (speed == 0)
+		bcm2835_i2c_set_baudrate(I2CBaudRate);
+	else
+		bcm2835_i2c_setClockDivider(speed);
+}
+
+/*!
+	@brief Set I2C slave address for following transfers
+	@param address I2C address
+*/
+void HD44780TransportBCM2835::I2CAddressSet(uint8_t address) { bcm2835_i2c_setSlaveAddress(address);}
+
+/*!
+	@brief Write a buffer in one I2C transaction
+	@param buffer bytes to write
+	@param length number of bytes
+	@return bcm2835I2CReasonCodes , BCM2835_I2C_REASON_OK 0x00 = Success
+*/
+uint8_t HD44780TransportBCM2835::I2CWrite(const char *buffer, uint32_t length)
+{
+	return bcm2835_i2c_write(buffer, length);
+}
+
+/*!
+	@brief Read bytes in one I2C transaction
+	@param buffer buffer to hold read bytes
+	@param length number of bytes
+	@return bcm2835I2CReasonCodes , BCM2835_I2C_REASON_OK 0x00 = Success
+*/
+uint8_t HD44780TransportBCM2835::I2CRead(char *buffer, uint32_t length)
+{
+	return bcm2835_i2c_read(buffer, length);
+}
+
+/*!
+	@brief Delay in milliseconds
+	@param ms delay
+*/
+void HD44780TransportBCM2835::DelayMs(uint32_t ms) { bcm2835_delay(ms);}
+
+/*!
+	@brief Delay in microseconds
+	@param us delay
+*/
+void HD44780TransportBCM2835::DelayUs(uint32_t us) { bcm2835_delayMicroseconds(us);}
+
+// Section : i2c-dev methods
+
+/*!
+	@brief Constructor for class HD44780TransportI2CDev
+	@param busNumber I2C bus, N in /dev/i2c-N, default 1
+*/
+HD44780TransportI2CDev::HD44780TransportI2CDev(uint8_t busNumber)
+{
+	I2CBusSet(busNumber);
+}
+
+/*!
+	@brief Destructor, closes the device if open
+*/
+HD44780TransportI2CDev::~HD44780TransportI2CDev() { I2CEnd();}
+
+/*!
+	@brief Open the i2c-dev device file
+	@return false for failure to open, check device exists and user in i2c group
+*/
+bool HD44780TransportI2CDev::I2CBegin(void)
+{
+	if (_FileDescriptor >= 0) return true;
+	_FileDescriptor = open(_DevicePath.c_str(), O_RDWR);
+	return (_FileDescriptor >= 0);
+}
+
+/*!
+	@brief Close the i2c-dev device file
+*/
+void HD44780TransportI2CDev::I2CEnd(void)
+{
+	if (_FileDescriptor < 0) return;
+	close(_FileDescriptor);
+	_FileDescriptor = -1;
+}
+
+/*!
+	@brief Does nothing, i2c-dev bus speed is set by the kernel
+	@param speed ignored
+	@note e.g. dtparam=i2c_arm_baudrate=400000 in /boot/config.txt on RPI
+*/
+void HD44780TransportI2CDev::I2CSpeedSet(uint16_t speed) { (void)speed;}
+
+/*!
+	@brief Set I2C slave address for following transfers
+	@param address I2C address
+*/
+void HD44780TransportI2CDev::I2CAddressSet(uint8_t address) { _SlaveAddress = address;}
+
+/*!
+	@brief Write a buffer in one I2C_RDWR ioctl
+	@param buffer bytes to write
+	@param length number of bytes
+	@return bcm2835I2CReasonCodes , BCM2835_I2C_REASON_OK 0x00 = Success
+	@details One i2c message for the whole write by default. With I2CMessageSizeSet the write 
+		is split into messages of whole LCD bytes, made longer if need be to fit the one ioctl, 
+		so a failure never follows part of the write sent by an earlier system call.
+*/
+uint8_t HD44780TransportI2CDev::I2CWrite(const char *buffer, uint32_t length)
+{
+	if (_FileDescriptor < 0) return BCM2835_I2C_REASON_ERROR_DATA;
+	if (length > static_cast<uint32_t>(I2CDEV_MSGS_MAX) * I2CDEV_MSG_LEN_MAX) return BCM2835_I2C_REASON_ERROR_DATA;
+
+	struct i2c_msg messages[I2CDEV_MSGS_MAX];
+	struct i2c_rdwr_ioctl_data packets;
+	uint32_t messageSize = (_MessageSize == 0 || _MessageSize > I2CDEV_MSG_LEN_MAX) ? I2CDEV_MSG_LEN_MAX : _MessageSize;
+	uint32_t fitSize = ((length + I2CDEV_MSGS_MAX - 1) / I2CDEV_MSGS_MAX + 3) & ~3U; // whole LCD bytes
+	if (messageSize < fitSize) messageSize = fitSize;
+	uint32_t offset = 0, numMessages = 0;
+
+	while (offset < length)
+	{
+		uint32_t size = length - offset;
+		if (size > messageSize) size = messageSize;
+		messages[numMessages].addr = _SlaveAddress;
+		messages[numMessages].flags = 0;
+		messages[numMessages].len = static_cast<uint16_t>(size);
+		messages[numMessages].buf = reinterpret_cast<uint8_t *>(const_cast<char *>(buffer + offset));
+		offset += size;
+		numMessages++;
+	}
+	if (numMessages == 0) return BCM2835_I2C_REASON_OK;
+	packets.msgs = messages;
+	packets.nmsgs = numMessages;
+	_IoctlCount++;
+	int result = ioctl(_FileDescriptor, I2C_RDWR, &packets);
+	if (result < 0) return I2CErrnoToReason(errno);
+	if (static_cast<uint32_t>(result) != numMessages) return BCM2835_I2C_REASON_ERROR_DATA;
+	return BCM2835_I2C_REASON_OK;
+}
+
+/*!
+	@brief Read bytes in one I2C_RDWR ioctl
+	@param buffer buffer to hold read bytes
+	@param length number of bytes
+	@return bcm2835I2CReasonCodes , BCM2835_I2C_REASON_OK 0x00 = Success
+*/
+uint8_t HD44780TransportI2CDev::I2CRead(char *buffer, uint32_t length)
+{
+	if (_FileDescriptor < 0) return BCM2835_I2C_REASON_ERROR_DATA;
+
+	struct i2c_msg message;
+	struct i2c_rdwr_ioctl_data packets;
+	message.addr = _SlaveAddress;
+	message.flags = I2C_M_RD;
+	message.len = static_cast<uint16_t>(length);
+	message.buf = reinterpret_cast<uint8_t *>(buffer);
+	packets.msgs = &message;
+	packets.nmsgs = 1;
+	_IoctlCount++;
+	if (ioctl(_FileDescriptor, I2C_RDWR, &packets) < 0) return I2CErrnoToReason(errno);
+	return BCM2835_I2C_REASON_OK;
+}
+
+/*!
+	@brief Delay in milliseconds
+	@param ms delay
+*/
+void HD44780TransportI2CDev::DelayMs(uint32_t ms)
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+/*!
+	@brief Delay in microseconds
+	@param us delay
+*/
+void HD44780TransportI2CDev::DelayUs(uint32_t us)
+{
+	std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+/*!
+	@brief Select the I2C bus, call before I2CBegin
+	@param busNumber N in /dev/i2c-N
+*/
+void HD44780TransportI2CDev::I2CBusSet(uint8_t busNumber)
+{
+	_DevicePath = "/dev/i2c-" + std::to_string(busNumber);
+}
+
+/*!
+	@brief Select the device file directly, call before I2CBegin
+	@param path device file path, e.g. an i2c-stub bus
+*/
+void HD44780TransportI2CDev::I2CDevicePathSet(const std::string &path) { _DevicePath = path;}
+
+/*!
+	@brief Get the device file path
+	@return device file path
+*/
+std::string HD44780TransportI2CDev::I2CDevicePathGet(void) { return _DevicePath;}
+
+/*!
+	@brief Set the max number of bytes per i2c message, for adapters that limit message length
+	@param bytes message size, 0 = the whole write as one message(default), 4 = one LCD byte.
+		Rounded up to whole LCD bytes, and made longer when a write would need more
+		than I2CDEV_MSGS_MAX messages, a write is always one ioctl.
+*/
+void HD44780TransportI2CDev::I2CMessageSizeSet(uint16_t bytes)
+{
+	_MessageSize = (bytes + 3) & ~3U;
+}
+
+/*!
+	@brief Get the number of I2C_RDWR system calls made
+	@return ioctl count
+*/
+uint32_t HD44780TransportI2CDev::I2CIoctlCountGet(void) { return _IoctlCount;}
+
+/*!
+	@brief Map a failed ioctl errno onto bcm2835I2CReasonCodes
+	@param error errno
+	@return reason code
+*/
+uint8_t HD44780TransportI2CDev::I2CErrnoToReason(int error)
+{
+	switch (error)
+	{
+		case ENXIO:
+		case EREMOTEIO: return BCM2835_I2C_REASON_ERROR_NACK;
+		case ETIMEDOUT: return BCM2835_I2C_REASON_ERROR_TIMEOUT;
+		case EAGAIN: return BCM2835_I2C_REASON_ERROR_CLKT;
+		default: return BCM2835_I2C_REASON_ERROR_DATA;
+	}
+}
+
+// **** EOF ****